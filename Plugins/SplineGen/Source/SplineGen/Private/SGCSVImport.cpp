@@ -0,0 +1,237 @@
+#include "SGCSVImport.h"
+#include "HAL/FileManager.h"
+
+// Bytes read from the file at a time. Rows can't be longer than this.
+static const int SGCSVChunkSize = 1 << 20;
+
+namespace ESGCSVColumn
+{
+	enum Type
+	{
+		PosX, PosY, PosZ,
+		FrontX, FrontY, FrontZ,
+		LeftX, LeftY, LeftZ,
+		UpX, UpY, UpZ,
+		Count
+	};
+}
+
+static const ANSICHAR* SGCSVColumnNames[ESGCSVColumn::Count] = { "PosX", "PosY", "PosZ", "FrontX", "FrontY", "FrontZ", "LeftX", "LeftY", "LeftZ", "UpX", "UpY", "UpZ" };
+
+// Trims spaces and quotes around a field in place.
+static ANSICHAR* SGTrimField(ANSICHAR* Start, ANSICHAR* End)
+{
+	while (Start < End && (*Start == ' ' || *Start == '"')) Start++;
+	while (End > Start && (End[-1] == ' ' || End[-1] == '"' || End[-1] == '\r')) End--;
+	*End = '\0';
+	return Start;
+}
+
+struct FSGCSVParser
+{
+	ANSICHAR Delimiter = ',';
+
+	// Column each field holds, or -1 for fields that aren't read. Fixed by the header.
+	TArray<int8> FieldColumns;
+
+	int64 Line = 0;
+
+	bool ParseHeader(ANSICHAR* Start, ANSICHAR* End, FString& OutError)
+	{
+		for (ANSICHAR Candidate : { '\t', ';', ',' })
+		{
+			if (!FCStringAnsi::Strchr(Start, Candidate)) continue;
+			Delimiter = Candidate;
+			break;
+		}
+
+		bool bFound[ESGCSVColumn::Count] = {};
+		while (Start <= End)
+		{
+			ANSICHAR* FieldEnd = Start;
+			while (FieldEnd < End && *FieldEnd != Delimiter) FieldEnd++;
+			const ANSICHAR* Name = SGTrimField(Start, FieldEnd);
+			int8 Column = -1;
+			for (int i = 0; i < ESGCSVColumn::Count; i++)
+			{
+				if (FCStringAnsi::Stricmp(Name, SGCSVColumnNames[i]) != 0) continue;
+				if (bFound[i])
+				{
+					OutError = FString::Printf(TEXT("Column %hs appears twice in the header."), SGCSVColumnNames[i]);
+					return false;
+				}
+				Column = int8(i);
+				bFound[i] = true;
+			}
+			FieldColumns.Emplace(Column);
+			Start = FieldEnd + 1;
+		}
+
+		for (int i = 0; i < ESGCSVColumn::Count; i++)
+		{
+			if (bFound[i]) continue;
+			OutError = FString::Printf(TEXT("Header has no %hs column."), SGCSVColumnNames[i]);
+			return false;
+		}
+		return true;
+	}
+
+	// Parses one row in place. Nothing is allocated per row.
+	bool ParseRow(ANSICHAR* Start, ANSICHAR* End, double (&OutValues)[ESGCSVColumn::Count], FString& OutError)
+	{
+		int NumRead = 0;
+		for (int Field = 0; Field < FieldColumns.Num() && Start <= End; Field++)
+		{
+			ANSICHAR* FieldEnd = Start;
+			while (FieldEnd < End && *FieldEnd != Delimiter) FieldEnd++;
+			const int8 Column = FieldColumns[Field];
+			if (Column >= 0)
+			{
+				ANSICHAR* Value = SGTrimField(Start, FieldEnd);
+				ANSICHAR* ValueEnd = nullptr;
+				OutValues[Column] = FCStringAnsi::Strtod(Value, &ValueEnd);
+				if (ValueEnd == Value || *ValueEnd != '\0')
+				{
+					OutError = FString::Printf(TEXT("Line %lld: %hs is not a number."), Line, SGCSVColumnNames[Column]);
+					return false;
+				}
+				// Strtod also reads nan and inf, which would reach the spline as points.
+				if (!FMath::IsFinite(OutValues[Column]))
+				{
+					OutError = FString::Printf(TEXT("Line %lld: %hs is not a finite number."), Line, SGCSVColumnNames[Column]);
+					return false;
+				}
+				NumRead++;
+			}
+			Start = FieldEnd + 1;
+		}
+		if (NumRead != ESGCSVColumn::Count)
+		{
+			OutError = FString::Printf(TEXT("Line %lld has %d of the %d track columns."), Line, NumRead, int(ESGCSVColumn::Count));
+			return false;
+		}
+		return true;
+	}
+};
+
+bool SGCSVImport::ReadTrackFile(const FString& Filename, float PositionScale, bool bConvertFromYUp, bool bClosedLoop, TArray<FSplinePointSetting>& OutPoints, FString& OutError)
+{
+	OutPoints.Reset();
+	TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*Filename));
+	if (!Reader)
+	{
+		OutError = FString::Printf(TEXT("Can't open %s."), *Filename);
+		return false;
+	}
+	const int64 FileSize = Reader->TotalSize();
+
+	auto Convert = [bConvertFromYUp](const double* Values) { return bConvertFromYUp ? FVector(Values[0], Values[2], Values[1]) : FVector(Values[0], Values[1], Values[2]); };
+
+	// One buffer for the whole file: the unfinished line of the last chunk is moved to the front before the next chunk is read after it.
+	TArray<ANSICHAR> Buffer;
+	Buffer.SetNumUninitialized(SGCSVChunkSize + 1);
+	FSGCSVParser Parser;
+	bool bHasHeader = false;
+	bool bReserved = false;
+	int Carry = 0;
+	int64 Remaining = FileSize;
+	while (Remaining > 0 || Carry > 0)
+	{
+		const int ReadSize = int(FMath::Min<int64>(Remaining, SGCSVChunkSize - Carry));
+		Reader->Serialize(Buffer.GetData() + Carry, ReadSize);
+		// A failed or short read would leave the rest of the chunk as whatever the buffer held before.
+		if (Reader->IsError())
+		{
+			OutError = FString::Printf(TEXT("Can't read %s past byte %lld."), *Filename, FileSize - Remaining);
+			return false;
+		}
+		Remaining -= ReadSize;
+		const int Filled = Carry + ReadSize;
+		// The last line may have no line break.
+		if (Remaining == 0) Buffer[Filled] = '\n';
+		const int Scan = Remaining == 0 ? Filled + 1 : Filled;
+
+		int LineStart = 0;
+		for (int i = 0; i < Scan; i++)
+		{
+			if (Buffer[i] != '\n') continue;
+			ANSICHAR* Start = Buffer.GetData() + LineStart;
+			ANSICHAR* End = Buffer.GetData() + i;
+			LineStart = i + 1;
+			Parser.Line++;
+			*End = '\0';
+			if (End - Start <= 1 && (Start == End || *Start == '\r')) continue;
+
+			if (!bHasHeader)
+			{
+				if (!Parser.ParseHeader(Start, End, OutError)) return false;
+				bHasHeader = true;
+				continue;
+			}
+
+			double Values[ESGCSVColumn::Count];
+			if (!Parser.ParseRow(Start, End, Values, OutError)) return false;
+			const FVector Front = Convert(Values + ESGCSVColumn::FrontX).GetSafeNormal();
+			const FVector Left = Convert(Values + ESGCSVColumn::LeftX);
+			const FVector Up = Convert(Values + ESGCSVColumn::UpX);
+			if (Front.IsZero() || Left.IsNearlyZero() || Up.IsNearlyZero())
+			{
+				OutError = FString::Printf(TEXT("Line %lld has a zero front, left or up vector."), Parser.Line);
+				return false;
+			}
+
+			FSplinePointSetting& Point = OutPoints.AddDefaulted_GetRef();
+			Point.LocationCoordSpace = ESplineCoordinateSpace::Local;
+			Point.Location = Convert(Values + ESGCSVColumn::PosX) * PositionScale;
+			Point.UpVectorCoordSpace = ESplineCoordinateSpace::Local;
+			// Exports round their vectors, so make the up vector perpendicular to the track again.
+			Point.UpVector = (Up - Front * FVector::DotProduct(Up, Front)).GetSafeNormal(UE_SMALL_NUMBER, Up.GetSafeNormal());
+			Point.TangentCoordSpace = ESplineCoordinateSpace::Local;
+			Point.Tangent = Front;
+		}
+
+		// Size the array from the rows per byte of the first chunk, so it grows about once.
+		if (!bReserved && OutPoints.Num() > 0 && Remaining > 0)
+		{
+			OutPoints.Reserve(int(FileSize * OutPoints.Num() / FMath::Max(LineStart, 1)) + 1024);
+			bReserved = true;
+		}
+
+		Carry = FMath::Max(Filled - LineStart, 0);
+		if (Remaining == 0) break;
+		if (Carry >= SGCSVChunkSize)
+		{
+			OutError = FString::Printf(TEXT("Line %lld is longer than %d bytes."), Parser.Line + 1, SGCSVChunkSize);
+			return false;
+		}
+		FMemory::Memmove(Buffer.GetData(), Buffer.GetData() + LineStart, Carry);
+	}
+	if (!bHasHeader)
+	{
+		OutError = FString::Printf(TEXT("%s is empty."), *Filename);
+		return false;
+	}
+
+	// Rows only give the direction. Tangents per unit input key are about as long as the distance to the neighbouring points.
+	const int NumPoints = OutPoints.Num();
+	for (int i = 0; i < NumPoints; i++)
+	{
+		const bool bHasPrevious = i > 0 || bClosedLoop;
+		const bool bHasNext = i < NumPoints - 1 || bClosedLoop;
+		const FVector& Location = OutPoints[i].Location;
+		double Length = 0.0;
+		int Count = 0;
+		if (bHasPrevious && NumPoints > 1)
+		{
+			Length += FVector::Dist(Location, OutPoints[(i + NumPoints - 1) % NumPoints].Location);
+			Count++;
+		}
+		if (bHasNext && NumPoints > 1)
+		{
+			Length += FVector::Dist(Location, OutPoints[(i + 1) % NumPoints].Location);
+			Count++;
+		}
+		OutPoints[i].Tangent *= Count > 0 ? Length / Count : 0.0;
+	}
+	return true;
+}
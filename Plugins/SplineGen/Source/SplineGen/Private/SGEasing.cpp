@@ -0,0 +1,110 @@
+#include "SGEasing.h"
+#include "Algo/BinarySearch.h"
+
+FSGEasing::FSGEasing(const FRollConfig& RollConfig)
+	: Exp(RollConfig.EaseExp),
+	bLinear(false)
+{
+	if (RollConfig.InOut == EInterpInOutSelection::None || RollConfig.EaseType == EInterpInOutType::Linear)
+	{
+		Bind<SGEasing::FLinear>();
+		bLinear = true;
+		return;
+	}
+	switch (RollConfig.EaseType)
+	{
+		case EInterpInOutType::Circular:
+			switch (RollConfig.InOut)
+			{
+			case EInterpInOutSelection::EaseIn: Bind<SGEasing::FCircularIn>(); return;
+			case EInterpInOutSelection::EaseOut: Bind<SGEasing::FCircularOut>(); return;
+			case EInterpInOutSelection::EaseInOut: Bind<SGEasing::FCircularInOut>(); return;
+			}
+		break;
+		case EInterpInOutType::Ease:
+			switch (RollConfig.InOut)
+			{
+			case EInterpInOutSelection::EaseIn: Bind<SGEasing::FEaseIn>(); return;
+			case EInterpInOutSelection::EaseOut: Bind<SGEasing::FEaseOut>(); return;
+			case EInterpInOutSelection::EaseInOut: Bind<SGEasing::FEaseInOut>(); return;
+			}
+		break;
+		case EInterpInOutType::Expo:
+			switch (RollConfig.InOut)
+			{
+			case EInterpInOutSelection::EaseIn: Bind<SGEasing::FExpoIn>(); return;
+			case EInterpInOutSelection::EaseOut: Bind<SGEasing::FExpoOut>(); return;
+			case EInterpInOutSelection::EaseInOut: Bind<SGEasing::FExpoInOut>(); return;
+			}
+		break;
+		case EInterpInOutType::Sine:
+			switch (RollConfig.InOut)
+			{
+			case EInterpInOutSelection::EaseIn: Bind<SGEasing::FSinIn>(); return;
+			case EInterpInOutSelection::EaseOut: Bind<SGEasing::FSinOut>(); return;
+			case EInterpInOutSelection::EaseInOut: Bind<SGEasing::FSinInOut>(); return;
+			}
+		break;
+		case EInterpInOutType::AutoEase:
+			Bind<SGEasing::FEaseInOut>();
+			return;
+	}
+	Bind<SGEasing::FLinear>();
+	bLinear = true;
+}
+
+FSGBezierEase::FSGBezierEase(float InStartX, float InEndX)
+	: StartX(FMath::Clamp(InStartX, 0.f, 1.f)),
+	EndX(FMath::Clamp(InEndX, 0.f, 1.f))
+{
+	// P0 = (0,0), P1 = (StartX,0), P2 = (EndX,1), P3 = (1,1).
+	CX = 3.f * StartX;
+	BX = 3.f * (EndX - 2.f * StartX);
+	AX = 1.f + 3.f * StartX - 3.f * EndX;
+	CY = 0.f;
+	BY = 3.f;
+	AY = -2.f;
+
+	for (int i = 0; i < TableSize; i++)
+	{
+		float T = float(i) / float(TableSize - 1);
+		XTable[i] = ((AX * T + BX) * T + CX) * T;
+	}
+	XTable[0] = 0.f;
+	XTable[TableSize - 1] = 1.f;
+}
+
+float FSGBezierEase::SolveT(float Alpha) const
+{
+	if (Alpha <= 0.f) return 0.f;
+	if (Alpha >= 1.f) return 1.f;
+
+	// Bracket Alpha in the table and start from the linear guess inside that interval.
+	int Upper = FMath::Clamp(int(Algo::UpperBound(TArrayView<const float>(XTable, TableSize), Alpha)), 1, TableSize - 1);
+	int Lower = Upper - 1;
+	float Span = XTable[Upper] - XTable[Lower];
+	float LowerT = float(Lower) / float(TableSize - 1);
+	float UpperT = float(Upper) / float(TableSize - 1);
+	float T = Span > UE_SMALL_NUMBER ? FMath::Lerp(LowerT, UpperT, (Alpha - XTable[Lower]) / Span) : LowerT;
+
+	for (int Iteration = 0; Iteration < 4; Iteration++)
+	{
+		float Error = ((AX * T + BX) * T + CX) * T - Alpha;
+		if (FMath::Abs(Error) < UE_KINDA_SMALL_NUMBER * 0.01f) break;
+		float Slope = (3.f * AX * T + 2.f * BX) * T + CX;
+		if (FMath::Abs(Slope) < UE_SMALL_NUMBER) break;
+		T = FMath::Clamp(T - Error / Slope, LowerT, UpperT);
+	}
+	return T;
+}
+
+float FSGBezierEase::Eval(float Alpha) const
+{
+	float T = SolveT(Alpha);
+	return ((AY * T + BY) * T + CY) * T;
+}
+
+void FSGBezierEase::EvalArray(TArrayView<float> Alphas) const
+{
+	for (float& Alpha : Alphas) Alpha = Eval(Alpha);
+}
@@ -0,0 +1,254 @@
+#include "SGFrameCompression.h"
+#include "SGSplineComponent.h"
+#include "Math/VectorRegister.h"
+
+// Queries decoded together by SampleTransforms. Each needs the two samples around it.
+static const int SGDecodeBlockSize = 64;
+
+static FORCEINLINE uint16 SGQuantiseSnorm(float Value)
+{
+	return uint16(FMath::RoundToInt((FMath::Clamp(Value, -1.f, 1.f) * 0.5f + 0.5f) * 65535.f));
+}
+
+static FORCEINLINE float SGDequantiseSnorm(uint16 Value)
+{
+	return float(Value) * (2.f / 65535.f) - 1.f;
+}
+
+static FORCEINLINE uint16 SGQuantiseAxis(double Value, double Min, float Step)
+{
+	return Step > 0.f ? uint16(FMath::Clamp(FMath::RoundToInt((Value - Min) / Step), 0, 65535)) : 0;
+}
+
+FVector2f SGOctahedral::Encode(const FVector3f& Normal)
+{
+	const float InvL1 = 1.f / (FMath::Abs(Normal.X) + FMath::Abs(Normal.Y) + FMath::Abs(Normal.Z));
+	const FVector2f P(Normal.X * InvL1, Normal.Y * InvL1);
+	if (Normal.Z >= 0.f) return P;
+
+	// Lower hemisphere folds out over the corners of the square.
+	return FVector2f((1.f - FMath::Abs(P.Y)) * (P.X >= 0.f ? 1.f : -1.f), (1.f - FMath::Abs(P.X)) * (P.Y >= 0.f ? 1.f : -1.f));
+}
+
+void SGOctahedral::DecodeArray(const float* U, const float* V, float* OutX, float* OutY, float* OutZ, int Num)
+{
+	// Z = 1 - |U| - |V|. Where it's negative, moving U and V towards zero by -Z unfolds the corners; this is the same as (1 - |V|) * Sign(U) and (1 - |U|) * Sign(V).
+	int i = 0;
+	const VectorRegister4Float Zero = VectorZeroFloat();
+	const VectorRegister4Float One = VectorOneFloat();
+	for (; i + 4 <= Num; i += 4)
+	{
+		VectorRegister4Float X = VectorLoad(U + i);
+		VectorRegister4Float Y = VectorLoad(V + i);
+		const VectorRegister4Float Z = VectorSubtract(VectorSubtract(One, VectorAbs(X)), VectorAbs(Y));
+		const VectorRegister4Float Fold = VectorMax(VectorNegate(Z), Zero);
+		X = VectorSelect(VectorCompareGE(X, Zero), VectorSubtract(X, Fold), VectorAdd(X, Fold));
+		Y = VectorSelect(VectorCompareGE(Y, Zero), VectorSubtract(Y, Fold), VectorAdd(Y, Fold));
+		const VectorRegister4Float InvLength = VectorReciprocalSqrtAccurate(VectorMultiplyAdd(X, X, VectorMultiplyAdd(Y, Y, VectorMultiply(Z, Z))));
+		VectorStore(VectorMultiply(X, InvLength), OutX + i);
+		VectorStore(VectorMultiply(Y, InvLength), OutY + i);
+		VectorStore(VectorMultiply(Z, InvLength), OutZ + i);
+	}
+	for (; i < Num; i++)
+	{
+		float X = U[i];
+		float Y = V[i];
+		const float Z = 1.f - FMath::Abs(X) - FMath::Abs(Y);
+		const float Fold = FMath::Max(-Z, 0.f);
+		X += X >= 0.f ? -Fold : Fold;
+		Y += Y >= 0.f ? -Fold : Fold;
+		const float InvLength = FMath::InvSqrt(X * X + Y * Y + Z * Z);
+		OutX[i] = X * InvLength;
+		OutY[i] = Y * InvLength;
+		OutZ[i] = Z * InvLength;
+	}
+}
+
+void FSGCompressedFrameTable::Reset()
+{
+	SamplesPerChunk = 0;
+	ChunkMins.Reset();
+	ChunkSteps.Reset();
+	PositionX.Reset();
+	PositionY.Reset();
+	PositionZ.Reset();
+	ForwardU.Reset();
+	ForwardV.Reset();
+	UpU.Reset();
+	UpV.Reset();
+	ScaleX.Reset();
+	ScaleY.Reset();
+	ScaleZ.Reset();
+}
+
+void FSGCompressedFrameTable::Encode(const FSGFrameTable& Frames, TArrayView<const FVector> Scales)
+{
+	Reset();
+	const int NumSamples = Frames.Num();
+	const int NumChunks = Frames.ChunkOrigins.Num();
+	if (NumSamples < 1 || NumChunks < 1 || Scales.Num() != NumSamples) return;
+	SamplesPerChunk = Frames.SamplesPerChunk;
+
+	TArray<FVector> Positions;
+	Positions.SetNumUninitialized(NumSamples);
+	TArray<FBox> Bounds;
+	Bounds.Init(FBox(ForceInit), NumChunks);
+	for (int i = 0; i < NumSamples; i++)
+	{
+		Positions[i] = Frames.GetPosition(i);
+		Bounds[Frames.GetChunk(i)] += Positions[i];
+	}
+	ChunkMins.SetNumUninitialized(NumChunks);
+	ChunkSteps.SetNumUninitialized(NumChunks);
+	for (int Chunk = 0; Chunk < NumChunks; Chunk++)
+	{
+		ChunkMins[Chunk] = Bounds[Chunk].IsValid ? Bounds[Chunk].Min : Frames.ChunkOrigins[Chunk];
+		ChunkSteps[Chunk] = Bounds[Chunk].IsValid ? FVector3f(Bounds[Chunk].GetSize() / 65535.0) : FVector3f::ZeroVector;
+	}
+
+	PositionX.SetNumUninitialized(NumSamples);
+	PositionY.SetNumUninitialized(NumSamples);
+	PositionZ.SetNumUninitialized(NumSamples);
+	ForwardU.SetNumUninitialized(NumSamples);
+	ForwardV.SetNumUninitialized(NumSamples);
+	UpU.SetNumUninitialized(NumSamples);
+	UpV.SetNumUninitialized(NumSamples);
+	ScaleX.SetNumUninitialized(NumSamples);
+	ScaleY.SetNumUninitialized(NumSamples);
+	ScaleZ.SetNumUninitialized(NumSamples);
+	for (int i = 0; i < NumSamples; i++)
+	{
+		const int Chunk = Frames.GetChunk(i);
+		PositionX[i] = SGQuantiseAxis(Positions[i].X, ChunkMins[Chunk].X, ChunkSteps[Chunk].X);
+		PositionY[i] = SGQuantiseAxis(Positions[i].Y, ChunkMins[Chunk].Y, ChunkSteps[Chunk].Y);
+		PositionZ[i] = SGQuantiseAxis(Positions[i].Z, ChunkMins[Chunk].Z, ChunkSteps[Chunk].Z);
+
+		const FQuat Rotation = Frames.GetRotation(i).GetNormalized();
+		const FVector2f Forward = SGOctahedral::Encode(FVector3f(Rotation.GetAxisX()));
+		const FVector2f Up = SGOctahedral::Encode(FVector3f(Rotation.GetAxisZ()));
+		ForwardU[i] = SGQuantiseSnorm(Forward.X);
+		ForwardV[i] = SGQuantiseSnorm(Forward.Y);
+		UpU[i] = SGQuantiseSnorm(Up.X);
+		UpV[i] = SGQuantiseSnorm(Up.Y);
+
+		ScaleX[i] = FFloat16(float(Scales[i].X));
+		ScaleY[i] = FFloat16(float(Scales[i].Y));
+		ScaleZ[i] = FFloat16(float(Scales[i].Z));
+	}
+}
+
+FVector FSGCompressedFrameTable::GetPosition(int Sample) const
+{
+	const int Chunk = GetChunk(Sample);
+	const FVector3f& Step = ChunkSteps[Chunk];
+	return ChunkMins[Chunk] + FVector(PositionX[Sample] * Step.X, PositionY[Sample] * Step.Y, PositionZ[Sample] * Step.Z);
+}
+
+void FSGCompressedFrameTable::DecodeAxes(int First, int Count, TArray<FVector3f>& OutForwards, TArray<FVector3f>& OutUps) const
+{
+	Count = FMath::Clamp(Count, 0, Num() - First);
+	TArray<float> U, V, X, Y, Z;
+	U.SetNumUninitialized(Count);
+	V.SetNumUninitialized(Count);
+	X.SetNumUninitialized(Count);
+	Y.SetNumUninitialized(Count);
+	Z.SetNumUninitialized(Count);
+	OutForwards.SetNumUninitialized(Count);
+	OutUps.SetNumUninitialized(Count);
+
+	for (int i = 0; i < Count; i++)
+	{
+		U[i] = SGDequantiseSnorm(ForwardU[First + i]);
+		V[i] = SGDequantiseSnorm(ForwardV[First + i]);
+	}
+	SGOctahedral::DecodeArray(U.GetData(), V.GetData(), X.GetData(), Y.GetData(), Z.GetData(), Count);
+	for (int i = 0; i < Count; i++) OutForwards[i] = FVector3f(X[i], Y[i], Z[i]);
+
+	for (int i = 0; i < Count; i++)
+	{
+		U[i] = SGDequantiseSnorm(UpU[First + i]);
+		V[i] = SGDequantiseSnorm(UpV[First + i]);
+	}
+	SGOctahedral::DecodeArray(U.GetData(), V.GetData(), X.GetData(), Y.GetData(), Z.GetData(), Count);
+	for (int i = 0; i < Count; i++) OutUps[i] = FVector3f(X[i], Y[i], Z[i]);
+}
+
+FQuat FSGCompressedFrameTable::SampleRotation(float Sample) const
+{
+	Sample = FMath::Clamp(Sample, 0.f, float(Num() - 1));
+	const int Index = FMath::Min(FMath::FloorToInt(Sample), Num() - 2);
+	const float Alpha = Sample - Index;
+	const float U[4] = { SGDequantiseSnorm(ForwardU[Index]), SGDequantiseSnorm(ForwardU[Index + 1]), SGDequantiseSnorm(UpU[Index]), SGDequantiseSnorm(UpU[Index + 1]) };
+	const float V[4] = { SGDequantiseSnorm(ForwardV[Index]), SGDequantiseSnorm(ForwardV[Index + 1]), SGDequantiseSnorm(UpV[Index]), SGDequantiseSnorm(UpV[Index + 1]) };
+	float X[4], Y[4], Z[4];
+	SGOctahedral::DecodeArray(U, V, X, Y, Z, 4);
+	const FVector Forward(FMath::Lerp(X[0], X[1], Alpha), FMath::Lerp(Y[0], Y[1], Alpha), FMath::Lerp(Z[0], Z[1], Alpha));
+	const FVector Up(FMath::Lerp(X[2], X[3], Alpha), FMath::Lerp(Y[2], Y[3], Alpha), FMath::Lerp(Z[2], Z[3], Alpha));
+	return FRotationMatrix::MakeFromXZ(Forward, Up).ToQuat();
+}
+
+void FSGCompressedFrameTable::SampleTransforms(TArrayView<const float> Samples, const FTransform& ToOutput, TArrayView<FTransform> OutTransforms) const
+{
+	// Per block, entries 2i and 2i + 1 hold the samples either side of query i.
+	float ForwardUs[SGDecodeBlockSize * 2], ForwardVs[SGDecodeBlockSize * 2], UpUs[SGDecodeBlockSize * 2], UpVs[SGDecodeBlockSize * 2];
+	float ForwardXs[SGDecodeBlockSize * 2], ForwardYs[SGDecodeBlockSize * 2], ForwardZs[SGDecodeBlockSize * 2];
+	float UpXs[SGDecodeBlockSize * 2], UpYs[SGDecodeBlockSize * 2], UpZs[SGDecodeBlockSize * 2];
+	int Indices[SGDecodeBlockSize];
+	float Alphas[SGDecodeBlockSize];
+
+	const int LastSample = Num() - 1;
+	for (int BlockStart = 0; BlockStart < Samples.Num(); BlockStart += SGDecodeBlockSize)
+	{
+		const int BlockCount = FMath::Min(SGDecodeBlockSize, Samples.Num() - BlockStart);
+		for (int i = 0; i < BlockCount; i++)
+		{
+			const float Sample = FMath::Clamp(Samples[BlockStart + i], 0.f, float(LastSample));
+			const int Index = FMath::Min(FMath::FloorToInt(Sample), LastSample - 1);
+			Indices[i] = Index;
+			Alphas[i] = Sample - Index;
+			for (int Side = 0; Side < 2; Side++)
+			{
+				ForwardUs[i * 2 + Side] = SGDequantiseSnorm(ForwardU[Index + Side]);
+				ForwardVs[i * 2 + Side] = SGDequantiseSnorm(ForwardV[Index + Side]);
+				UpUs[i * 2 + Side] = SGDequantiseSnorm(UpU[Index + Side]);
+				UpVs[i * 2 + Side] = SGDequantiseSnorm(UpV[Index + Side]);
+			}
+		}
+		SGOctahedral::DecodeArray(ForwardUs, ForwardVs, ForwardXs, ForwardYs, ForwardZs, BlockCount * 2);
+		SGOctahedral::DecodeArray(UpUs, UpVs, UpXs, UpYs, UpZs, BlockCount * 2);
+
+		for (int i = 0; i < BlockCount; i++)
+		{
+			const float Alpha = Alphas[i];
+			const int A = i * 2;
+			const int B = A + 1;
+			const FVector Forward(FMath::Lerp(ForwardXs[A], ForwardXs[B], Alpha), FMath::Lerp(ForwardYs[A], ForwardYs[B], Alpha), FMath::Lerp(ForwardZs[A], ForwardZs[B], Alpha));
+			const FVector Up(FMath::Lerp(UpXs[A], UpXs[B], Alpha), FMath::Lerp(UpYs[A], UpYs[B], Alpha), FMath::Lerp(UpZs[A], UpZs[B], Alpha));
+			const FVector Location = FMath::Lerp(GetPosition(Indices[i]), GetPosition(Indices[i] + 1), double(Alpha));
+			OutTransforms[BlockStart + i] = FTransform(FRotationMatrix::MakeFromXZ(Forward, Up).ToQuat(), Location) * ToOutput;
+		}
+	}
+}
+
+float FSGCompressedFrameTable::GetPositionErrorBound() const
+{
+	float Bound = 0.f;
+	for (const FVector3f& Step : ChunkSteps) Bound = FMath::Max(Bound, 0.5f * Step.Size());
+	return Bound;
+}
+
+void FSGCompressedFrameTable::Serialize(FArchive& Ar)
+{
+	Ar << SamplesPerChunk << ChunkMins << ChunkSteps;
+	Ar << PositionX << PositionY << PositionZ;
+	Ar << ForwardU << ForwardV << UpU << UpV;
+	Ar << ScaleX << ScaleY << ScaleZ;
+}
+
+SIZE_T FSGCompressedFrameTable::GetAllocatedSize() const
+{
+	return ChunkMins.GetAllocatedSize() + ChunkSteps.GetAllocatedSize()
+		+ PositionX.GetAllocatedSize() + PositionY.GetAllocatedSize() + PositionZ.GetAllocatedSize()
+		+ ForwardU.GetAllocatedSize() + ForwardV.GetAllocatedSize() + UpU.GetAllocatedSize() + UpV.GetAllocatedSize()
+		+ ScaleX.GetAllocatedSize() + ScaleY.GetAllocatedSize() + ScaleZ.GetAllocatedSize();
+}
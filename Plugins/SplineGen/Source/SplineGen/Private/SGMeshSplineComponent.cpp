@@ -2,6 +2,16 @@
 
 #include "SGMeshSplineComponent.h"
 #include "Runtime/Engine/Classes/Kismet/KismetMathLibrary.h"
+#include "SplineGenBPLibrary.h"
+#include "SGSplineCursor.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/Crc.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
 
 // Sets default values for this component's properties
 USGMeshSplineComponent::USGMeshSplineComponent()
@@ -22,7 +32,10 @@ void USGMeshSplineComponent::BeginPlay()
 void USGMeshSplineComponent::EndPlay(EEndPlayReason::Type EndPlayReason)
 {
 	SetComponentTickEnabled(false);
-	DeleteAll();
+	// When the level or owner is going away, the owner already unregisters and releases every mesh it owns, so only drop our references.
+	const AActor* Owner = GetOwner();
+	if (EndPlayReason != EEndPlayReason::Destroyed || !Owner || Owner->IsActorBeingDestroyed()) AllMeshes.Empty();
+	else DeleteAll();
 	Super::EndPlay(EndPlayReason);
 }
 
@@ -45,30 +58,29 @@ void USGMeshSplineComponent::UpdateSection(int SplinePoint, FSectionStyle Style,
 	}
 	if (SplinePoint < 0) return;
 
-	ESplineCoordinateSpace::Type WS = ESplineCoordinateSpace::World;
+	TArray<FSGMeshPieceRecord> Pieces;
+	ComputeSectionPieces(SplinePoint, Pieces);
+	ApplySectionPieces(SplinePoint, Style, Pieces);
+}
+
+void USGMeshSplineComponent::ComputeSectionPieces(int SplinePoint, TArray<FSGMeshPieceRecord>& OutPieces)
+{
 	ESplineCoordinateSpace::Type LS = ESplineCoordinateSpace::Local;
 
-	float StartDistSection = GetDistanceAlongSplineAtSplinePoint(SplinePoint);
-	float EndDistSection = GetDistanceAlongSplineAtSplinePoint(GetNextSplinePoint(SplinePoint));
-	float SectionLength = GetSegmentLength(SplinePoint);
-	int MeshCount = FMath::RoundToInt(SectionLength / TargetMeshLength);
-	float InKeyStep = 1.f / float(MeshCount);
-	float MeshLength = SectionLength / MeshCount;
+	const FSGSegmentLayout Layout = GetSegmentLayout(SplinePoint);
+	float StartDistSection = Layout.StartDistance;
+	float EndDistSection = Layout.StartDistance + Layout.Length;
+	int MeshCount = Layout.PieceCount;
+	float InKeyStep = MeshCount > 0 ? 1.f / float(MeshCount) : 0.f;
+	float MeshLength = Layout.PieceLength;
 
 	UE_LOG(LogTemp, Display, TEXT("section mesh length: %f"), MeshLength);
 
-	if (AllMeshes.Num() - 1 < SplinePoint) AllMeshes.SetNum(SplinePoint + 1);
-	if (AllMeshes[SplinePoint].Meshes.Num() < MeshCount) AllMeshes[SplinePoint].Meshes.SetNum(MeshCount);
-
-	int CurrentMeshesNum = AllMeshes[SplinePoint].Meshes.Num();
-
-	
-
-	// Cycle through all meshes to create/update.
 	// Need to convert this to distance along spline!
+	OutPieces.SetNumUninitialized(MeshCount);
+	FSGSplineCursor Cursor(this);
 	for (int i = 0; i < MeshCount; i++)
 	{
-		USplineMeshComponent* CurrentMesh = AllMeshes[SplinePoint].Meshes[i];
 		float StartDistance = StartDistSection + (MeshLength * i);
 		float EndDistance = (i < MeshCount - 1) ? (StartDistance + MeshLength) : EndDistSection; // Fixes the gap between the last mesh and next section.
 		bool bIsFinalMesh = SplinePoint >= GetLastSplinePoint() && i >= MeshCount - 1;
@@ -76,6 +88,56 @@ void USGMeshSplineComponent::UpdateSection(int SplinePoint, FSectionStyle Style,
 		//float LastDistance = IsClosedLoop() ? FMath::Wrap((StartDistance - MeshLength), 0.f, GetSplineLength()) : (StartDistance - MeshLength);
 		//float NextDistance = IsClosedLoop() ? FMath::Wrap((EndDistance + MeshLength), 0.f, GetSplineLength()) : (EndDistance + MeshLength);
 
+		const float StartKey = Cursor.GetInputKeyAtDistance(StartDistance);
+		const float EndKey = Cursor.GetInputKeyAtDistance(EndDistance);
+		FVector StartLoc = EvalPosition(StartKey);
+		FVector EndLoc = EvalPosition(EndKey);
+		FVector StartTan = EvalPositionDerivative(StartKey) * InKeyStep;
+		FVector EndTan = EvalPositionDerivative(EndKey) * InKeyStep;
+		FVector OverrideTangentNext = FVector::ZeroVector;
+		if (bEnableLocalOffset)
+		{
+			if (bEnableSmoothTangentsForLocalOffset)
+			{
+				StartLoc = GetLocalOffsetLocationAtDistanceAlongSplineFromOffsetSpline(StartDistance, LS);
+				EndLoc = GetLocalOffsetLocationAtDistanceAlongSplineFromOffsetSpline(EndDistance, LS);
+				StartTan = GetLocalOffsetTangentAtDistanceAlongSplineFromOffsetSpline(StartDistance, LS);
+				EndTan = GetLocalOffsetTangentAtDistanceAlongSplineFromOffsetSpline(EndDistance, LS);
+				OverrideTangentNext = EndTan;
+			}
+			else
+			{
+				StartLoc = GetLocalOffsetLocationAtSplineInputKey(StartKey, LocalOffset, LS);
+				EndLoc = GetLocalOffsetLocationAtSplineInputKey(EndKey, LocalOffset, LS);
+			}
+		}
+
+		FSGMeshPieceRecord& Piece = OutPieces[i];
+		Piece.StartLocation = FVector3f(StartLoc);
+		Piece.StartTangent = FVector3f(StartTan);
+		Piece.EndLocation = FVector3f(EndLoc);
+		Piece.EndTangent = FVector3f(EndTan);
+		Piece.UpDir = FVector3f(GetCorrectUpVectorAtSplineInputKey(StartKey, LS));
+		Piece.StartScale = FVector2f(MapScaleTo2D(EvalScale(StartKey)));
+		Piece.EndScale = FVector2f(MapScaleTo2D(EvalScale(EndKey)));
+		Piece.EndRoll = FindDeltaRollAtSplineInputKey(StartKey, EndKey, OverrideTangentNext);
+	}
+}
+
+void USGMeshSplineComponent::ApplySectionPieces(int SplinePoint, FSectionStyle Style, TArrayView<const FSGMeshPieceRecord> Pieces)
+{
+	const int MeshCount = Pieces.Num();
+	if (AllMeshes.Num() - 1 < SplinePoint) AllMeshes.SetNum(SplinePoint + 1);
+	if (AllMeshes[SplinePoint].Meshes.Num() < MeshCount) AllMeshes[SplinePoint].Meshes.SetNum(MeshCount);
+
+	int CurrentMeshesNum = AllMeshes[SplinePoint].Meshes.Num();
+
+	// Cycle through all meshes to create/update.
+	for (int i = 0; i < MeshCount; i++)
+	{
+		USplineMeshComponent* CurrentMesh = AllMeshes[SplinePoint].Meshes[i];
+		const FSGMeshPieceRecord& Piece = Pieces[i];
+
 		// Spawn spline mesh if not exist.
 		if (!CurrentMesh)
 		{
@@ -92,37 +154,15 @@ void USGMeshSplineComponent::UpdateSection(int SplinePoint, FSectionStyle Style,
 		for (int j = 0; j < Style.Materials.Num(); j++) if (Style.Materials[j]) CurrentMesh->SetMaterial(j, Style.Materials[j]);
 
 		// Transform updates.
-		FVector StartLoc = GetLocationAtDistanceAlongSpline(StartDistance, LS);
-		FVector EndLoc = GetLocationAtDistanceAlongSpline(EndDistance, LS);
-		FVector StartTan = GetTangentAtDistanceAlongSpline(StartDistance, LS) * InKeyStep;
-		FVector EndTan = GetTangentAtDistanceAlongSpline(EndDistance, LS) * InKeyStep;
-		FVector OverrideTangentNext = FVector::ZeroVector;
-		if (bEnableLocalOffset)
-		{
-			if (bEnableSmoothTangentsForLocalOffset)
-			{
-				StartLoc = GetLocalOffsetLocationAtDistanceAlongSplineFromOffsetSpline(StartDistance, LS);
-				EndLoc = GetLocalOffsetLocationAtDistanceAlongSplineFromOffsetSpline(EndDistance, LS);
-				StartTan = GetLocalOffsetTangentAtDistanceAlongSplineFromOffsetSpline(StartDistance, LS);
-				EndTan = GetLocalOffsetTangentAtDistanceAlongSplineFromOffsetSpline(EndDistance, LS);
-				OverrideTangentNext = EndTan;
-			}
-			else
-			{
-				StartLoc = GetLocalOffsetLocationAtDistanceAlongSpline(StartDistance, LocalOffset, LS);
-				EndLoc = GetLocalOffsetLocationAtDistanceAlongSpline(EndDistance, LocalOffset, LS);
-			}
-		}
-		CurrentMesh->SetStartAndEnd(StartLoc, StartTan, EndLoc, EndTan, false);
+		CurrentMesh->SetStartAndEnd(FVector(Piece.StartLocation), FVector(Piece.StartTangent), FVector(Piece.EndLocation), FVector(Piece.EndTangent), false);
 
-		CurrentMesh->SetStartScale(MapScaleTo2D(GetScaleAtDistanceAlongSpline(StartDistance)));
-		CurrentMesh->SetEndScale(MapScaleTo2D(GetScaleAtDistanceAlongSpline(EndDistance)));
+		CurrentMesh->SetStartScale(FVector2D(Piece.StartScale));
+		CurrentMesh->SetEndScale(FVector2D(Piece.EndScale));
 
-		CurrentMesh->SetSplineUpDir(GetCorrectUpVectorAtDistanceAlongSpline(StartDistance, LS), true);
+		CurrentMesh->SetSplineUpDir(FVector(Piece.UpDir), true);
 
-		float EndRoll = FindDeltaRollAtDistanceAlongSpline(StartDistance, EndDistance, OverrideTangentNext);
 		CurrentMesh->SetStartRoll(0.f, false);
-		CurrentMesh->SetEndRoll(EndRoll, false);
+		CurrentMesh->SetEndRoll(Piece.EndRoll, false);
 
 		// Final updates.
 		CurrentMesh->UpdateMesh();
@@ -146,6 +186,11 @@ FVector2D USGMeshSplineComponent::MapScaleTo2D(FVector Scale)
 }
 
 float USGMeshSplineComponent::FindDeltaRollAtDistanceAlongSpline(float StartDist, float EndDist, FVector OverrideTangentNext)
+{
+	return FindDeltaRollAtSplineInputKey(GetCorrectInputKeyAtDistanceAlongSpline(StartDist), GetCorrectInputKeyAtDistanceAlongSpline(EndDist), OverrideTangentNext);
+}
+
+float USGMeshSplineComponent::FindDeltaRollAtSplineInputKey(float StartKey, float EndKey, FVector OverrideTangentNext)
 {
 	ESplineCoordinateSpace::Type WS = ESplineCoordinateSpace::World;
 	ESplineCoordinateSpace::Type LS = ESplineCoordinateSpace::Local;
@@ -156,10 +201,10 @@ float USGMeshSplineComponent::FindDeltaRollAtDistanceAlongSpline(float StartDist
 	//FQuat End = GetCorrectQuaternionAtDistanceAlongSpline(EndDist, LS);
 	
 	FVector TangentNext;// = GetTangentAtDistanceAlongSpline(EndDist, WS);
-	if (OverrideTangentNext == FVector::ZeroVector) TangentNext = GetTangentAtDistanceAlongSpline(EndDist, WS);
+	if (OverrideTangentNext == FVector::ZeroVector) TangentNext = GetTangentAtSplineInputKey(EndKey, WS);
 	else TangentNext = OverrideTangentNext;
-	FVector UpVectorCurrent = GetCorrectUpVectorAtDistanceAlongSpline(StartDist, WS);
-	FVector UpVectorNext = GetCorrectUpVectorAtDistanceAlongSpline(EndDist, WS);
+	FVector UpVectorCurrent = GetCorrectUpVectorAtSplineInputKey(StartKey, WS);
+	FVector UpVectorNext = GetCorrectUpVectorAtSplineInputKey(EndKey, WS);
 	FVector CrossProductCurrent = FVector::CrossProduct(TangentNext.GetSafeNormal(), UpVectorCurrent);
 	FVector CrossProductNext = FVector::CrossProduct(TangentNext.GetSafeNormal(), UpVectorNext);
 	FVector CrossProductBoth = FVector::CrossProduct(CrossProductCurrent, CrossProductNext).GetSafeNormal();
@@ -178,13 +223,529 @@ float USGMeshSplineComponent::FindDeltaRollAtDistanceAlongSpline(float StartDist
 
 void USGMeshSplineComponent::UpdateAll(TArray<FSectionStyle> Styles, bool bUpdateTransforms)
 {
+	FSHAHash CacheKey;
+	if (bUseTrackCache)
+	{
+		CacheKey = ComputeTrackCacheKey();
+		if (LoadTrackCache(CacheKey, Styles)) return;
+	}
+
 	UpdateSGSplines();
-	for (int i = 0; i < GetNumberOfSplineSegments(); i++)
+	const int NumSections = GetNumberOfSplineSegments();
+	TArray<TArray<FSGMeshPieceRecord>> SectionPieces;
+	SectionPieces.SetNum(NumSections);
+	for (int i = 0; i < NumSections; i++)
 	{
 		FSectionStyle UseStyle = DefaultStyle;
 		if (Styles.IsValidIndex(i)) UseStyle = Styles[i];
-		UpdateSection(i, UseStyle, bUpdateTransforms);
+		ComputeSectionPieces(i, SectionPieces[i]);
+		ApplySectionPieces(i, UseStyle, SectionPieces[i]);
 	}
+	if (bUseTrackCache) SaveTrackCache(CacheKey, SectionPieces);
+}
+
+// Track cache files: a header, the derived spline data as USGSplineComponent::SerializeDerivedData writes it, the first piece of every section, then the pieces.
+// Bump SGTrackCacheVersion whenever any of these, or the way pieces are computed, changes.
+static const uint32 SGTrackCacheMagic = 0x43544753; // "SGTC"
+static const uint32 SGTrackCacheVersion = 1;
+
+// Offsets are aligned to this so sections and pieces can be read in place from the mapped file.
+static const int64 SGTrackCacheAlignment = 16;
+
+struct FSGTrackCacheHeader
+{
+	uint32 Magic;
+	uint32 Version;
+	uint8 Key[20];
+	// Of everything after the header.
+	uint32 PayloadCrc;
+	int32 NumSections;
+	int64 DerivedDataOffset;
+	int64 DerivedDataSize;
+	int64 SectionStartsOffset;
+	int64 PiecesOffset;
+	int64 NumPieces;
+};
+
+static_assert(sizeof(FSGMeshPieceRecord) == 17 * sizeof(float) && TIsTriviallyCopyable<FSGMeshPieceRecord>::Value, "Track cache files store FSGMeshPieceRecord as raw floats.");
+
+static FString SGGetTrackCacheDir()
+{
+	return FPaths::ProjectSavedDir() / TEXT("SplineGen") / TEXT("TrackCache");
+}
+
+// Largest cache file in bytes. Cache files are read into and viewed through int32 sized arrays, so Blueprint values past ClampMax are held to that too.
+static int64 SGTrackCacheFileSizeLimit(int MaxFileSizeMB)
+{
+	return FMath::Min<int64>(int64(MaxFileSizeMB) * 1024 * 1024, MAX_int32);
+}
+
+FSHAHash USGMeshSplineComponent::ComputeTrackCacheKey() const
+{
+	const FSHAHash DerivedDataHash = ComputeDerivedDataHash();
+	const uint32 Version = SGTrackCacheVersion;
+	const FVector3f Scale(GetComponentScale());
+	FSHA1 Sha;
+	Sha.Update(DerivedDataHash.Hash, sizeof(DerivedDataHash.Hash));
+	Sha.Update(reinterpret_cast<const uint8*>(&Version), sizeof(Version));
+	Sha.Update(reinterpret_cast<const uint8*>(&Scale), sizeof(Scale));
+	Sha.Final();
+
+	FSHAHash Key;
+	Sha.GetHash(Key.Hash);
+	return Key;
+}
+
+bool USGMeshSplineComponent::LoadTrackCache(const FSHAHash& Key, const TArray<FSectionStyle>& Styles)
+{
+	const double StartTime = FPlatformTime::Seconds();
+	const FString Filename = SGGetTrackCacheDir() / Key.ToString() + TEXT(".sgcache");
+	const int64 FileSize = IFileManager::Get().FileSize(*Filename);
+	if (FileSize < int64(sizeof(FSGTrackCacheHeader)) || FileSize > SGTrackCacheFileSizeLimit(MaxTrackCacheFileSizeMB)) return false;
+
+	// Map the file where the platform can, otherwise read it.
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	TArray<uint8> FileBytes;
+	TArrayView<const uint8> File;
+	FOpenMappedResult MapResult = FPlatformFileManager::Get().GetPlatformFile().OpenMappedEx(*Filename);
+	if (MapResult.HasValue())
+	{
+		MappedFile = MapResult.StealValue();
+		MappedRegion.Reset(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+	}
+	if (MappedRegion) File = TArrayView<const uint8>(MappedRegion->GetMappedPtr(), int32(MappedRegion->GetMappedSize()));
+	else if (FFileHelper::LoadFileToArray(FileBytes, *Filename)) File = FileBytes;
+	if (File.Num() < int32(sizeof(FSGTrackCacheHeader))) return false;
+
+	// Validate everything before touching the component.
+	FSGTrackCacheHeader Header;
+	FMemory::Memcpy(&Header, File.GetData(), sizeof(Header));
+	const int64 Size = File.Num();
+	const int NumSections = GetNumberOfSplineSegments();
+	const bool bHeaderValid = Header.Magic == SGTrackCacheMagic && Header.Version == SGTrackCacheVersion && FMemory::Memcmp(Header.Key, Key.Hash, sizeof(Header.Key)) == 0
+		&& Header.NumSections == NumSections && Header.NumPieces >= 0
+		&& Header.DerivedDataOffset >= int64(sizeof(Header)) && Header.DerivedDataSize >= 0 && Header.DerivedDataOffset + Header.DerivedDataSize <= Header.SectionStartsOffset
+		&& Header.SectionStartsOffset % SGTrackCacheAlignment == 0 && Header.SectionStartsOffset + int64(NumSections + 1) * sizeof(int32) <= Header.PiecesOffset
+		&& Header.PiecesOffset % SGTrackCacheAlignment == 0 && Header.PiecesOffset + Header.NumPieces * int64(sizeof(FSGMeshPieceRecord)) == Size;
+	if (!bHeaderValid || FCrc::MemCrc32(File.GetData() + sizeof(Header), int32(Size - sizeof(Header))) != Header.PayloadCrc)
+	{
+		UE_LOG(LogTemp, Display, TEXT("Track cache file %s is stale or damaged, rebuilding it."), *Filename);
+		return false;
+	}
+	const int32* SectionStarts = reinterpret_cast<const int32*>(File.GetData() + Header.SectionStartsOffset);
+	const FSGMeshPieceRecord* Pieces = reinterpret_cast<const FSGMeshPieceRecord*>(File.GetData() + Header.PiecesOffset);
+	if (SectionStarts[0] != 0 || SectionStarts[NumSections] != Header.NumPieces) return false;
+	for (int i = 0; i < NumSections; i++) if (SectionStarts[i + 1] < SectionStarts[i]) return false;
+
+	// Adopted by UpdateSGSplines the same way as data loaded with the component. A blob that doesn't read leaves the component untouched.
+	FMemoryReaderView Reader(File.Slice(int32(Header.DerivedDataOffset), int32(Header.DerivedDataSize)));
+	if (!SerializeDerivedData(Reader))
+	{
+		UE_LOG(LogTemp, Display, TEXT("Track cache file %s is stale or damaged, rebuilding it."), *Filename);
+		return false;
+	}
+	SerializedDerivedDataHash = ComputeDerivedDataHash();
+	bHasSerializedDerivedData = true;
+	UpdateSGSplines();
+	const double AdoptedTime = FPlatformTime::Seconds();
+
+	for (int i = 0; i < NumSections; i++)
+	{
+		FSectionStyle UseStyle = DefaultStyle;
+		if (Styles.IsValidIndex(i)) UseStyle = Styles[i];
+		ApplySectionPieces(i, UseStyle, TArrayView<const FSGMeshPieceRecord>(Pieces + SectionStarts[i], SectionStarts[i + 1] - SectionStarts[i]));
+	}
+
+	// Cache hits count as use when trimming.
+	IFileManager::Get().SetTimeStamp(*Filename, FDateTime::UtcNow());
+	const double EndTime = FPlatformTime::Seconds();
+	UE_LOG(LogTemp, Display, TEXT("Track cache hit: %d sections, %lld pieces in %.2f ms (spline %.2f ms, apply %.2f ms)."),
+		NumSections, Header.NumPieces, (EndTime - StartTime) * 1000.0, (AdoptedTime - StartTime) * 1000.0, (EndTime - AdoptedTime) * 1000.0);
+	return true;
+}
+
+void USGMeshSplineComponent::SaveTrackCache(const FSHAHash& Key, const TArray<TArray<FSGMeshPieceRecord>>& SectionPieces)
+{
+	TArray<uint8> DerivedData;
+	FMemoryWriter DerivedDataWriter(DerivedData);
+	SerializeDerivedData(DerivedDataWriter);
+
+	const int NumSections = SectionPieces.Num();
+	TArray<int32> SectionStarts;
+	SectionStarts.SetNumUninitialized(NumSections + 1);
+	SectionStarts[0] = 0;
+	for (int i = 0; i < NumSections; i++) SectionStarts[i + 1] = SectionStarts[i] + SectionPieces[i].Num();
+
+	FSGTrackCacheHeader Header;
+	FMemory::Memzero(Header);
+	Header.Magic = SGTrackCacheMagic;
+	Header.Version = SGTrackCacheVersion;
+	FMemory::Memcpy(Header.Key, Key.Hash, sizeof(Header.Key));
+	Header.NumSections = NumSections;
+	Header.DerivedDataOffset = sizeof(Header);
+	Header.DerivedDataSize = DerivedData.Num();
+	Header.SectionStartsOffset = Align(Header.DerivedDataOffset + Header.DerivedDataSize, SGTrackCacheAlignment);
+	Header.PiecesOffset = Align(Header.SectionStartsOffset + int64(SectionStarts.Num()) * sizeof(int32), SGTrackCacheAlignment);
+	Header.NumPieces = SectionStarts.Last();
+	const int64 FileSize = Header.PiecesOffset + Header.NumPieces * int64(sizeof(FSGMeshPieceRecord));
+	if (FileSize > SGTrackCacheFileSizeLimit(MaxTrackCacheFileSizeMB))
+	{
+		UE_LOG(LogTemp, Display, TEXT("Track cache file would be %lld bytes, over MaxTrackCacheFileSizeMB. Not caching this track."), FileSize);
+		return;
+	}
+
+	TArray<uint8> Bytes;
+	Bytes.SetNumZeroed(int32(FileSize));
+	FMemory::Memcpy(Bytes.GetData() + Header.DerivedDataOffset, DerivedData.GetData(), DerivedData.Num());
+	FMemory::Memcpy(Bytes.GetData() + Header.SectionStartsOffset, SectionStarts.GetData(), SectionStarts.Num() * sizeof(int32));
+	uint8* PieceBytes = Bytes.GetData() + Header.PiecesOffset;
+	for (const TArray<FSGMeshPieceRecord>& Pieces : SectionPieces)
+	{
+		FMemory::Memcpy(PieceBytes, Pieces.GetData(), Pieces.Num() * sizeof(FSGMeshPieceRecord));
+		PieceBytes += Pieces.Num() * sizeof(FSGMeshPieceRecord);
+	}
+	Header.PayloadCrc = FCrc::MemCrc32(Bytes.GetData() + sizeof(Header), int32(FileSize - sizeof(Header)));
+	FMemory::Memcpy(Bytes.GetData(), &Header, sizeof(Header));
+
+	// Write to a temporary file first, so a reader never maps a half written one.
+	const FString CacheDir = SGGetTrackCacheDir();
+	const FString Filename = CacheDir / Key.ToString() + TEXT(".sgcache");
+	const FString TempFilename = Filename + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(Bytes, *TempFilename) || !IFileManager::Get().Move(*Filename, *TempFilename, true, true))
+	{
+		IFileManager::Get().Delete(*TempFilename, false, false, true);
+		return;
+	}
+
+	// Trim least recently used files until the directory fits.
+	TArray<FString> Files;
+	IFileManager::Get().FindFiles(Files, *(CacheDir / TEXT("*.sgcache")), true, false);
+	TArray<TPair<FDateTime, FString>> ByAge;
+	int64 TotalSize = 0;
+	for (const FString& File : Files)
+	{
+		const FString Path = CacheDir / File;
+		TotalSize += FMath::Max<int64>(IFileManager::Get().FileSize(*Path), 0);
+		ByAge.Emplace(IFileManager::Get().GetTimeStamp(*Path), Path);
+	}
+	ByAge.Sort([](const TPair<FDateTime, FString>& A, const TPair<FDateTime, FString>& B) { return A.Key < B.Key; });
+	const int64 MaxTotalSize = int64(MaxTrackCacheSizeMB) * 1024 * 1024;
+	for (int i = 0; i < ByAge.Num() && TotalSize > MaxTotalSize; i++)
+	{
+		if (ByAge[i].Value == Filename) continue;
+		const int64 Size = FMath::Max<int64>(IFileManager::Get().FileSize(*ByAge[i].Value), 0);
+		if (IFileManager::Get().Delete(*ByAge[i].Value, false, false, true)) TotalSize -= Size;
+	}
+}
+
+void USGMeshSplineComponent::ClearTrackCache()
+{
+	IFileManager::Get().DeleteDirectory(*SGGetTrackCacheDir(), false, true);
+}
+
+// Binary track format. Bump SGTrackVersion when the layout changes, and keep reading older versions in LoadTrackFromBytes.
+static const uint32 SGTrackMagic = 0x4B544753; // "SGTK"
+static const uint32 SGTrackVersion = 1;
+
+// Palette index of sections that use the default style.
+static const uint16 SGTrackNoStyle = MAX_uint16;
+
+enum ESGTrackFlags : uint32
+{
+	SGTrackFlag_ClosedLoop = 1 << 0,
+	SGTrackFlag_LocalOffset = 1 << 1,
+	SGTrackFlag_SmoothLocalOffsetTangents = 1 << 2
+};
+
+// Bytes FInterpCurvePoint<float> takes in an archive: InVal, OutVal, both tangents and the one byte interp mode.
+static const int64 SGTrackRollPointSize = 4 * sizeof(float) + 1;
+
+// Peeks the element count at the read position of a loading archive, and fails the archive if that many elements of at least MinElementSize bytes
+// can't fit in the rest of it. Keeps a bad count from allocating more than the file could hold.
+static bool SGCheckTrackCount(FArchive& Ar, int64 MinElementSize)
+{
+	if (Ar.IsError()) return false;
+	if (!Ar.IsLoading()) return true;
+	const int64 Start = Ar.Tell();
+	int32 Num = 0;
+	Ar << Num;
+	Ar.Seek(Start);
+	// FString writes UTF-16 lengths as negative counts.
+	const int64 Count = FMath::Abs(int64(Num));
+	const int64 ElementSize = Num < 0 ? MinElementSize * 2 : MinElementSize;
+	if (Ar.IsError() || Count * ElementSize > Ar.TotalSize() - Start - int64(sizeof(int32)))
+	{
+		Ar.SetError();
+		return false;
+	}
+	return true;
+}
+
+template<typename ElementT>
+static void SGSerializeTrackArray(FArchive& Ar, TArray<ElementT>& Array, int64 MinElementSize = sizeof(ElementT))
+{
+	if (SGCheckTrackCount(Ar, MinElementSize)) Ar << Array;
+}
+
+static void SGSerializeTrackStylePaths(FArchive& Ar, TArray<TArray<FString>>& StylePaths)
+{
+	if (!Ar.IsLoading())
+	{
+		Ar << StylePaths;
+		return;
+	}
+	// Nested arrays and strings each get their count checked before anything is allocated for them.
+	if (!SGCheckTrackCount(Ar, sizeof(int32))) return;
+	int32 NumStyles = 0;
+	Ar << NumStyles;
+	StylePaths.SetNum(NumStyles);
+	for (TArray<FString>& Paths : StylePaths)
+	{
+		if (!SGCheckTrackCount(Ar, sizeof(int32))) return;
+		int32 NumPaths = 0;
+		Ar << NumPaths;
+		Paths.SetNum(NumPaths);
+		for (FString& Path : Paths)
+		{
+			if (!SGCheckTrackCount(Ar, sizeof(ANSICHAR))) return;
+			Ar << Path;
+		}
+	}
+}
+
+// Everything in the format except the header, in the order it's written. Loading reads into this first, so a bad file leaves the track as it was.
+struct FSGTrackData
+{
+	uint32 Flags = 0;
+	uint8 UpVectorMode = 0;
+	float TargetMeshLength = 0.f;
+	FVector2f LocalOffset = FVector2f::ZeroVector;
+
+	TArray<FVector3f> Locations;
+	TArray<FVector3f> ArriveTangents;
+	TArray<FVector3f> LeaveTangents;
+	TArray<FQuat4f> Rotations;
+	TArray<FVector3f> Scales;
+	TArray<uint8> PointTypes;
+
+	TArray<uint8> RollEaseTypes;
+	TArray<uint8> RollInOuts;
+	TArray<float> RollEaseExps;
+	FInterpCurveFloat RollChannel;
+	float RollChannelLoopTwist = 0.f;
+
+	// Asset paths per palette style: the mesh, then its materials.
+	TArray<TArray<FString>> StylePaths;
+	TArray<uint16> SectionStyles;
+
+	void Serialize(FArchive& Ar)
+	{
+		Ar << Flags << UpVectorMode << TargetMeshLength << LocalOffset;
+		SGSerializeTrackArray(Ar, Locations);
+		SGSerializeTrackArray(Ar, ArriveTangents);
+		SGSerializeTrackArray(Ar, LeaveTangents);
+		SGSerializeTrackArray(Ar, Rotations);
+		SGSerializeTrackArray(Ar, Scales);
+		SGSerializeTrackArray(Ar, PointTypes);
+		SGSerializeTrackArray(Ar, RollEaseTypes);
+		SGSerializeTrackArray(Ar, RollInOuts);
+		SGSerializeTrackArray(Ar, RollEaseExps);
+		if (!SGCheckTrackCount(Ar, SGTrackRollPointSize)) return;
+		Ar << RollChannel << RollChannelLoopTwist;
+		SGSerializeTrackStylePaths(Ar, StylePaths);
+		SGSerializeTrackArray(Ar, SectionStyles);
+	}
+
+	bool IsValid() const
+	{
+		const int NumPoints = Locations.Num();
+		if (ArriveTangents.Num() != NumPoints || LeaveTangents.Num() != NumPoints || Rotations.Num() != NumPoints || Scales.Num() != NumPoints || PointTypes.Num() != NumPoints) return false;
+		if (RollInOuts.Num() != RollEaseTypes.Num() || RollEaseExps.Num() != RollEaseTypes.Num()) return false;
+		if (UpVectorMode > uint8(ESGUpVectorMode::NoRoll)) return false;
+		// Non-positive or non-finite mesh lengths turn into negative piece and sample counts downstream.
+		if (!FMath::IsFinite(TargetMeshLength) || TargetMeshLength <= 0.f || LocalOffset.ContainsNaN() || !FMath::IsFinite(RollChannelLoopTwist)) return false;
+		for (int i = 0; i < NumPoints; i++)
+		{
+			if (Locations[i].ContainsNaN() || ArriveTangents[i].ContainsNaN() || LeaveTangents[i].ContainsNaN() || Rotations[i].ContainsNaN() || Scales[i].ContainsNaN()) return false;
+		}
+		for (float EaseExp : RollEaseExps) if (!FMath::IsFinite(EaseExp)) return false;
+		for (const FInterpCurvePoint<float>& Point : RollChannel.Points)
+		{
+			if (!FMath::IsFinite(Point.InVal) || !FMath::IsFinite(Point.OutVal) || !FMath::IsFinite(Point.ArriveTangent) || !FMath::IsFinite(Point.LeaveTangent) || Point.InterpMode >= CIM_Unknown) return false;
+		}
+		if (!FMath::IsFinite(RollChannel.LoopKeyOffset)) return false;
+		for (uint8 PointType : PointTypes) if (PointType >= CIM_Unknown) return false;
+		for (uint8 EaseType : RollEaseTypes) if (EaseType > uint8(EInterpInOutType::AutoEase)) return false;
+		for (uint8 InOut : RollInOuts) if (InOut > uint8(EInterpInOutSelection::EaseInOut)) return false;
+		for (uint16 Style : SectionStyles) if (Style != SGTrackNoStyle && !StylePaths.IsValidIndex(Style)) return false;
+		return true;
+	}
+};
+
+static bool SGStylesMatch(const FSectionStyle& A, const FSectionStyle& B)
+{
+	return A.Mesh == B.Mesh && A.Materials == B.Materials;
+}
+
+void USGMeshSplineComponent::SaveTrackToBytes(TArray<uint8>& OutBytes)
+{
+	FSGTrackData Data;
+	Data.Flags = (IsClosedLoop() ? SGTrackFlag_ClosedLoop : 0) | (bEnableLocalOffset ? SGTrackFlag_LocalOffset : 0) | (bEnableSmoothTangentsForLocalOffset ? SGTrackFlag_SmoothLocalOffsetTangents : 0);
+	Data.UpVectorMode = uint8(UpVectorMode);
+	Data.TargetMeshLength = TargetMeshLength;
+	Data.LocalOffset = FVector2f(LocalOffset);
+
+	// Up vectors live in the point rotations, so the rotations are stored as they are.
+	const int NumPoints = GetNumberOfSplinePoints();
+	Data.Locations.SetNumUninitialized(NumPoints);
+	Data.ArriveTangents.SetNumUninitialized(NumPoints);
+	Data.LeaveTangents.SetNumUninitialized(NumPoints);
+	Data.Rotations.SetNumUninitialized(NumPoints);
+	Data.Scales.SetNumUninitialized(NumPoints);
+	Data.PointTypes.SetNumUninitialized(NumPoints);
+	for (int i = 0; i < NumPoints; i++)
+	{
+		const FInterpCurvePoint<FVector>& Point = SplineCurves.Position.Points[i];
+		Data.Locations[i] = FVector3f(Point.OutVal);
+		Data.ArriveTangents[i] = FVector3f(Point.ArriveTangent);
+		Data.LeaveTangents[i] = FVector3f(Point.LeaveTangent);
+		Data.PointTypes[i] = uint8(Point.InterpMode.GetValue());
+		Data.Rotations[i] = FQuat4f(SplineCurves.Rotation.Points[i].OutVal);
+		Data.Scales[i] = FVector3f(SplineCurves.Scale.Points[i].OutVal);
+	}
+
+	for (const FRollConfig& RollConfig : SegmentRollConfigs)
+	{
+		Data.RollEaseTypes.Emplace(uint8(RollConfig.EaseType));
+		Data.RollInOuts.Emplace(uint8(RollConfig.InOut));
+		Data.RollEaseExps.Emplace(RollConfig.EaseExp);
+	}
+	Data.RollChannel = SplineCurveRoll;
+	Data.RollChannelLoopTwist = RollChannelLoopTwist;
+
+	TArray<FSectionStyle> Palette;
+	const int NumSections = GetNumberOfSplineSegments();
+	Data.SectionStyles.Init(SGTrackNoStyle, NumSections);
+	for (int i = 0; i < NumSections; i++)
+	{
+		if (!AllMeshes.IsValidIndex(i) || !AllMeshes[i].Meshes.IsValidIndex(0) || !AllMeshes[i].Meshes[0]) continue;
+		const FSectionStyle Style = GetStyleFromSplineMesh(AllMeshes[i].Meshes[0]);
+		int StyleIndex = Palette.IndexOfByPredicate([&Style](const FSectionStyle& Other) { return SGStylesMatch(Style, Other); });
+		if (StyleIndex == INDEX_NONE) StyleIndex = Palette.Emplace(Style);
+		Data.SectionStyles[i] = uint16(StyleIndex);
+	}
+	for (const FSectionStyle& Style : Palette)
+	{
+		TArray<FString>& Paths = Data.StylePaths.AddDefaulted_GetRef();
+		Paths.Emplace(FSoftObjectPath(Style.Mesh).ToString());
+		for (UMaterialInterface* Material : Style.Materials) Paths.Emplace(FSoftObjectPath(Material).ToString());
+	}
+
+	OutBytes.Reset();
+	FMemoryWriter Writer(OutBytes);
+	uint32 Magic = SGTrackMagic;
+	uint32 Version = SGTrackVersion;
+	Writer << Magic << Version;
+	Data.Serialize(Writer);
+}
+
+bool USGMeshSplineComponent::LoadTrackFromBytes(const TArray<uint8>& Bytes, bool bUpdateSections)
+{
+	const double StartTime = FPlatformTime::Seconds();
+
+	FMemoryReader Reader(Bytes);
+	uint32 Magic = 0;
+	uint32 Version = 0;
+	Reader << Magic << Version;
+	if (Reader.IsError() || Magic != SGTrackMagic || Version < 1 || Version > SGTrackVersion)
+	{
+		UE_LOG(LogTemp, Display, TEXT("LoadTrackFromBytes: not a track, or a newer version (%u) than this build reads."), Version);
+		return false;
+	}
+	FSGTrackData Data;
+	Data.Serialize(Reader);
+	if (Reader.IsError() || !Data.IsValid())
+	{
+		UE_LOG(LogTemp, Display, TEXT("LoadTrackFromBytes: track data is truncated or inconsistent."));
+		return false;
+	}
+	const double ParsedTime = FPlatformTime::Seconds();
+
+	const int NumPoints = Data.Locations.Num();
+	TArray<FInterpCurvePoint<FVector>>& Positions = SplineCurves.Position.Points;
+	TArray<FInterpCurvePoint<FQuat>>& Rotations = SplineCurves.Rotation.Points;
+	TArray<FInterpCurvePoint<FVector>>& Scales = SplineCurves.Scale.Points;
+	Positions.SetNumUninitialized(NumPoints);
+	Rotations.SetNumUninitialized(NumPoints);
+	Scales.SetNumUninitialized(NumPoints);
+	for (int i = 0; i < NumPoints; i++)
+	{
+		const float Key = float(i);
+		Positions[i] = FInterpCurvePoint<FVector>(Key, FVector(Data.Locations[i]), FVector(Data.ArriveTangents[i]), FVector(Data.LeaveTangents[i]), EInterpCurveMode(Data.PointTypes[i]));
+		Rotations[i] = FInterpCurvePoint<FQuat>(Key, FQuat(Data.Rotations[i]), FQuat::Identity, FQuat::Identity, CIM_CurveAuto);
+		Scales[i] = FInterpCurvePoint<FVector>(Key, FVector(Data.Scales[i]), FVector::ZeroVector, FVector::ZeroVector, CIM_CurveAuto);
+	}
+
+	SegmentRollConfigs.SetNum(Data.RollEaseTypes.Num());
+	for (int i = 0; i < SegmentRollConfigs.Num(); i++)
+	{
+		SegmentRollConfigs[i].EaseType = EInterpInOutType(Data.RollEaseTypes[i]);
+		SegmentRollConfigs[i].InOut = EInterpInOutSelection(Data.RollInOuts[i]);
+		SegmentRollConfigs[i].EaseExp = Data.RollEaseExps[i];
+	}
+	SplineCurveRoll = MoveTemp(Data.RollChannel);
+	RollChannelLoopTwist = Data.RollChannelLoopTwist;
+	UpVectorMode = ESGUpVectorMode(Data.UpVectorMode);
+	TargetMeshLength = Data.TargetMeshLength;
+	LocalOffset = FVector2D(Data.LocalOffset);
+	bEnableLocalOffset = (Data.Flags & SGTrackFlag_LocalOffset) != 0;
+	bEnableSmoothTangentsForLocalOffset = (Data.Flags & SGTrackFlag_SmoothLocalOffsetTangents) != 0;
+	CurrentSelection.Reset();
+
+	// The one spline update. Derived data follows lazily, in UpdateAll below or on the first query.
+	SetClosedLoop((Data.Flags & SGTrackFlag_ClosedLoop) != 0, false);
+	UpdateSpline();
+	const double SplineTime = FPlatformTime::Seconds();
+
+	if (bUpdateSections)
+	{
+		TArray<FSectionStyle> Palette;
+		for (const TArray<FString>& Paths : Data.StylePaths)
+		{
+			FSectionStyle& Style = Palette.AddDefaulted_GetRef();
+			if (Paths.Num() == 0) continue;
+			Style.Mesh = Cast<UStaticMesh>(FSoftObjectPath(Paths[0]).TryLoad());
+			for (int i = 1; i < Paths.Num(); i++) Style.Materials.Emplace(Cast<UMaterialInterface>(FSoftObjectPath(Paths[i]).TryLoad()));
+		}
+		TArray<FSectionStyle> Styles;
+		Styles.SetNum(Data.SectionStyles.Num());
+		for (int i = 0; i < Styles.Num(); i++)
+		{
+			Styles[i] = Data.SectionStyles[i] != SGTrackNoStyle ? Palette[Data.SectionStyles[i]] : DefaultStyle;
+		}
+		UpdateAll(Styles, true);
+		DeleteUnusedSections();
+	}
+	const double EndTime = FPlatformTime::Seconds();
+
+	UE_LOG(LogTemp, Display, TEXT("Loaded track: %d points, %d bytes in %.2f ms (parse %.2f ms, spline %.2f ms, sections %.2f ms)."),
+		NumPoints, Bytes.Num(), (EndTime - StartTime) * 1000.0, (ParsedTime - StartTime) * 1000.0, (SplineTime - ParsedTime) * 1000.0, (EndTime - SplineTime) * 1000.0);
+	return true;
+}
+
+bool USGMeshSplineComponent::SaveTrackToFile(const FString& Filename)
+{
+	TArray<uint8> Bytes;
+	SaveTrackToBytes(Bytes);
+	return FFileHelper::SaveArrayToFile(Bytes, *Filename);
+}
+
+bool USGMeshSplineComponent::LoadTrackFromFile(const FString& Filename, bool bUpdateSections)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Filename)) return false;
+	return LoadTrackFromBytes(Bytes, bUpdateSections);
 }
 
 void USGMeshSplineComponent::UpdateSelection(TArray<int> Selection, FSectionStyle Style, bool bUpdateTransforms)
@@ -217,9 +778,106 @@ void USGMeshSplineComponent::SetCurrentSelection(TArray<int> NewSelection)
 	CurrentSelection = NewSelection;
 }
 
+TArray<int> USGMeshSplineComponent::GetSplinePointsInBox(FBox WorldBox, bool bMergeIntoCurrentSelection)
+{
+	TArray<int> Result;
+	UpdateControlPointGrid();
+	const FTransform& ComponentTransform = GetComponentTransform();
+
+	// Cull cells with the local space bounds of the world box, then test points exactly in world space.
+	const FBox LocalBox = WorldBox.InverseTransformBy(ComponentTransform);
+	ControlPointGrid.ForEachCellInBox(LocalBox, [&](const FIntVector& Cell, TArrayView<const int32> CellPoints)
+	{
+		for (int32 Point : CellPoints)
+		{
+			if (WorldBox.IsInsideOrOn(ComponentTransform.TransformPosition(ControlPointGrid.Points[Point]))) Result.Emplace(Point);
+		}
+	});
+
+	Result.Sort();
+	if (bMergeIntoCurrentSelection) MergeIntoCurrentSelection(Result);
+	return Result;
+}
+
+static bool SGProjectWorldToScreen(const FVector& WorldLocation, const FMatrix& ViewProjectionMatrix, const FVector2D& ViewportSize, FVector2D& OutScreenLocation)
+{
+	const FPlane Result = ViewProjectionMatrix.TransformFVector4(FVector4(WorldLocation, 1.f));
+	if (Result.W <= 0.f) return false;
+	const double RHW = 1.0 / Result.W;
+	OutScreenLocation = FVector2D((Result.X * RHW * 0.5 + 0.5) * ViewportSize.X, (0.5 - Result.Y * RHW * 0.5) * ViewportSize.Y);
+	return true;
+}
+
+static bool SGIsPointInPolygon(const FVector2D& Point, const TArray<FVector2D>& Polygon)
+{
+	bool bInside = false;
+	for (int32 i = 0, j = Polygon.Num() - 1; i < Polygon.Num(); j = i++)
+	{
+		const FVector2D& A = Polygon[i];
+		const FVector2D& B = Polygon[j];
+		if ((A.Y > Point.Y) != (B.Y > Point.Y) && Point.X < (B.X - A.X) * (Point.Y - A.Y) / (B.Y - A.Y) + A.X) bInside = !bInside;
+	}
+	return bInside;
+}
+
+TArray<int> USGMeshSplineComponent::GetSplinePointsInScreenPolygon(const TArray<FVector2D>& ScreenPolygon, FMatrix ViewProjectionMatrix, FVector2D ViewportSize, bool bMergeIntoCurrentSelection)
+{
+	TArray<int> Result;
+	if (ScreenPolygon.Num() < 3 || ViewportSize.X <= 0.0 || ViewportSize.Y <= 0.0) return Result;
+	UpdateControlPointGrid();
+	const FTransform& ComponentTransform = GetComponentTransform();
+	const FBox2D PolygonBounds(ScreenPolygon);
+
+	// The polygon's screen bounds as clip space planes in local space: column J of the local to clip matrix gives clip coordinate J, so
+	// MinX <= X / W becomes (Column X - MinX * Column W) . (x, y, z, 1) >= 0, and so on. W > 0 keeps points behind the camera out.
+	const FMatrix LocalToClip = ComponentTransform.ToMatrixWithScale() * ViewProjectionMatrix;
+	auto Column = [&LocalToClip](int32 J) { return FVector4(LocalToClip.M[0][J], LocalToClip.M[1][J], LocalToClip.M[2][J], LocalToClip.M[3][J]); };
+	const FVector4 ClipX = Column(0);
+	const FVector4 ClipY = Column(1);
+	const FVector4 ClipW = Column(3);
+	const double MinX = PolygonBounds.Min.X / ViewportSize.X * 2.0 - 1.0;
+	const double MaxX = PolygonBounds.Max.X / ViewportSize.X * 2.0 - 1.0;
+	const double MinY = 1.0 - PolygonBounds.Max.Y / ViewportSize.Y * 2.0;
+	const double MaxY = 1.0 - PolygonBounds.Min.Y / ViewportSize.Y * 2.0;
+	const FVector4 Planes[] = { ClipX - ClipW * MinX, ClipW * MaxX - ClipX, ClipY - ClipW * MinY, ClipW * MaxY - ClipY, ClipW };
+
+	ControlPointGrid.ForEachCellInRegion(MakeArrayView(Planes), [&](const FIntVector& Cell, TArrayView<const int32> CellPoints)
+	{
+		for (int32 Point : CellPoints)
+		{
+			FVector2D ScreenLocation;
+			if (!SGProjectWorldToScreen(ComponentTransform.TransformPosition(ControlPointGrid.Points[Point]), ViewProjectionMatrix, ViewportSize, ScreenLocation)) continue;
+			if (PolygonBounds.IsInside(ScreenLocation) && SGIsPointInPolygon(ScreenLocation, ScreenPolygon)) Result.Emplace(Point);
+		}
+	});
+
+	Result.Sort();
+	if (bMergeIntoCurrentSelection) MergeIntoCurrentSelection(Result);
+	return Result;
+}
+
+void USGMeshSplineComponent::MergeIntoCurrentSelection(const TArray<int>& Points)
+{
+	CurrentSelection.Append(Points);
+	CurrentSelection.Sort();
+	for (int i = CurrentSelection.Num() - 1; i > 0; i--)
+	{
+		if (CurrentSelection[i] == CurrentSelection[i - 1]) CurrentSelection.RemoveAt(i, 1, EAllowShrinking::No);
+	}
+}
+
+void USGMeshSplineComponent::UpdateControlPointGrid()
+{
+	// Rebuilt after UpdateSpline, or when points were added or removed without one. Like the rest of the derived data, points moved with
+	// bUpdateSpline = false are picked at their old locations until the next UpdateSpline. Comparing every location here would make each query O(n).
+	if (ControlPointGridRevision == GetSplineRevision() && ControlPointGrid.Num() == SplineCurves.Position.Points.Num()) return;
+	ControlPointGrid.Build(SplineCurves.Position);
+	ControlPointGridRevision = GetSplineRevision();
+}
+
 void USGMeshSplineComponent::AddToSelection(int Point)
 {
-	CurrentSelection.Emplace(Point);
+	CurrentSelection.AddUnique(Point);
 }
 
 void USGMeshSplineComponent::RemoveFromSelection(int Point)
@@ -235,6 +893,7 @@ float USGMeshSplineComponent::GetTargetMeshLength()
 void USGMeshSplineComponent::SetTargetMeshLength(float NewTargetMeshLength)
 {
 	TargetMeshLength = NewTargetMeshLength;
+	UpdateSegmentLayouts();
 }
 
 void USGMeshSplineComponent::SetStyleOnSelected(FSectionStyle Style)
@@ -242,6 +901,65 @@ void USGMeshSplineComponent::SetStyleOnSelected(FSectionStyle Style)
 	UpdateSelection(CurrentSelection, Style, false);
 }
 
+void USGMeshSplineComponent::ApplyTransformToSelection(FTransform Delta, FVector Pivot, ESplineCoordinateSpace::Type CoordinateSpace, bool bUpdateSections)
+{
+	const bool bWorld = CoordinateSpace == ESplineCoordinateSpace::World;
+	const FTransform& ComponentTransform = GetComponentTransform();
+	const FQuat DeltaRotation = Delta.GetRotation();
+	bool bAnyChanged = false;
+
+	// SetCurrentSelection takes any array, so skip repeated points rather than moving them twice.
+	TArray<int> Points = CurrentSelection;
+	Points.Sort();
+	for (int i = 0; i < Points.Num(); i++)
+	{
+		const int Point = Points[i];
+		if (i > 0 && Point == Points[i - 1]) continue;
+		if (!SplineCurves.Position.Points.IsValidIndex(Point) || !SplineCurves.Rotation.Points.IsValidIndex(Point)) continue;
+		FInterpCurvePoint<FVector>& PositionPoint = SplineCurves.Position.Points[Point];
+		FInterpCurvePoint<FQuat>& RotationPoint = SplineCurves.Rotation.Points[Point];
+
+		FVector Location = PositionPoint.OutVal;
+		FVector ArriveTangent = PositionPoint.ArriveTangent;
+		FVector LeaveTangent = PositionPoint.LeaveTangent;
+		FQuat Rotation = RotationPoint.OutVal;
+		if (bWorld)
+		{
+			Location = ComponentTransform.TransformPosition(Location);
+			ArriveTangent = ComponentTransform.TransformVector(ArriveTangent);
+			LeaveTangent = ComponentTransform.TransformVector(LeaveTangent);
+			Rotation = ComponentTransform.GetRotation() * Rotation;
+		}
+
+		Location = Pivot + Delta.TransformPosition(Location - Pivot);
+		ArriveTangent = Delta.TransformVector(ArriveTangent);
+		LeaveTangent = Delta.TransformVector(LeaveTangent);
+		// The up vector spline is built from point rotations, so rotating these carries the up vectors along.
+		Rotation = DeltaRotation * Rotation;
+
+		if (bWorld)
+		{
+			Location = ComponentTransform.InverseTransformPosition(Location);
+			ArriveTangent = ComponentTransform.InverseTransformVector(ArriveTangent);
+			LeaveTangent = ComponentTransform.InverseTransformVector(LeaveTangent);
+			Rotation = ComponentTransform.GetRotation().Inverse() * Rotation;
+		}
+
+		PositionPoint.OutVal = Location;
+		PositionPoint.ArriveTangent = ArriveTangent;
+		PositionPoint.LeaveTangent = LeaveTangent;
+		RotationPoint.OutVal = Rotation.GetNormalized();
+		bAnyChanged = true;
+	}
+	if (!bAnyChanged) return;
+
+	// One full spline update and, with bUpdateSections, one full derived data rebuild in UpdateSelection, however many points moved. Neither can be limited to the
+	// moved segments: USplineComponent rebuilds its reparam table for the whole spline, distances after the edit shift, and EasedRoll frames are transported from
+	// the start of the track, so every frame after the first moved point changes. Only the sections are rebuilt per affected segment.
+	UpdateSpline();
+	if (bUpdateSections) UpdateSelection(CurrentSelection, FSectionStyle(), true);
+}
+
 void USGMeshSplineComponent::StartSelectionEditOperation()
 {
 	SetComponentTickEnabled(true);
@@ -275,13 +993,12 @@ void USGMeshSplineComponent::DeleteUnusedSections()
 
 void USGMeshSplineComponent::DeleteAll()
 {
-	for (auto Meshes : AllMeshes)
+	TArray<USplineMeshComponent*> ToDestroy;
+	for (const FSplineMeshSection& Section : AllMeshes)
 	{
-		for (auto Mesh : Meshes.Meshes)
-		{
-			if (Mesh) Mesh->DestroyComponent();
-		}
+		ToDestroy.Append(Section.Meshes);
 	}
+	USplineGenBPLibrary::DestroySplineMeshes(ToDestroy);
 	AllMeshes.Empty();
 }
 
@@ -355,3 +1072,156 @@ void USGMeshSplineComponent::SplineSetClosedLoop(bool bInClosedLoop, bool bUpdat
 		DeleteSection(GetLastSegment() + 1, true);
 	}
 }
+
+
+void FSGControlPointGrid::Build(const FInterpCurveVector& Position)
+{
+	const int32 NumPoints = Position.Points.Num();
+	Points.SetNumUninitialized(NumPoints);
+	for (int32 i = 0; i < NumPoints; i++) Points[i] = Position.Points[i].OutVal;
+
+	// Aim for roughly two points per cell.
+	const FBox Bounds = FBox(Points).ExpandBy(1.0);
+	const FVector Size = Bounds.GetSize();
+	const double TargetCells = FMath::Max(1.0, NumPoints * 0.5);
+	CellSize = FMath::Pow(Size.X * Size.Y * Size.Z / TargetCells, 1.0 / 3.0);
+
+	// Flat or straight tracks: axes thinner than a cell don't contribute to the cell count.
+	int32 NumAxes = 0;
+	double Extent = 1.0;
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		if (Size[Axis] < CellSize) continue;
+		Extent *= Size[Axis];
+		NumAxes++;
+	}
+	if (NumAxes > 0 && NumAxes < 3) CellSize = FMath::Pow(Extent / TargetCells, 1.0 / NumAxes);
+	// At most 256 cells per axis, with cells large enough that their boxes still hold every point.
+	CellSize = FMath::Max3(CellSize, Size.GetMax() / 256.0, 1.0);
+	Origin = Bounds.Min;
+	Dims = FIntVector(
+		FMath::Clamp(FMath::CeilToInt(Size.X / CellSize), 1, 256),
+		FMath::Clamp(FMath::CeilToInt(Size.Y / CellSize), 1, 256),
+		FMath::Clamp(FMath::CeilToInt(Size.Z / CellSize), 1, 256));
+
+	// Counting sort of points into cells.
+	const int32 NumCells = Dims.X * Dims.Y * Dims.Z;
+	TArray<int32> PointCells;
+	PointCells.SetNumUninitialized(NumPoints);
+	CellStarts.SetNumZeroed(NumCells + 1);
+	for (int32 i = 0; i < NumPoints; i++)
+	{
+		const FIntVector Cell = GetCellCoord(Points[i]);
+		PointCells[i] = Cell.X + (Cell.Y * Dims.X) + (Cell.Z * Dims.X * Dims.Y);
+		CellStarts[PointCells[i] + 1]++;
+	}
+	for (int32 i = 0; i < NumCells; i++) CellStarts[i + 1] += CellStarts[i];
+
+	TArray<int32> Cursor(CellStarts.GetData(), NumCells);
+	PointIndices.SetNumUninitialized(NumPoints);
+	for (int32 i = 0; i < NumPoints; i++) PointIndices[Cursor[PointCells[i]]++] = i;
+}
+
+FIntVector FSGControlPointGrid::GetCellCoord(const FVector& LocalLocation) const
+{
+	const FVector Relative = (LocalLocation - Origin) / CellSize;
+	return FIntVector(
+		FMath::Clamp(FMath::FloorToInt(Relative.X), 0, Dims.X - 1),
+		FMath::Clamp(FMath::FloorToInt(Relative.Y), 0, Dims.Y - 1),
+		FMath::Clamp(FMath::FloorToInt(Relative.Z), 0, Dims.Z - 1));
+}
+
+void FSGControlPointGrid::GetCellBox(const FIntVector& Cell, FBox& OutBox) const
+{
+	const FVector Min = Origin + FVector(Cell) * CellSize;
+	OutBox = FBox(Min, Min + FVector(CellSize));
+}
+
+void FSGControlPointGrid::ForEachCellInBox(const FBox& LocalBox, TFunctionRef<void(const FIntVector&, TArrayView<const int32>)> Visitor) const
+{
+	if (Num() == 0) return;
+	const FBox GridBox(Origin, Origin + FVector(Dims) * CellSize);
+	if (!LocalBox.Intersect(GridBox)) return;
+
+	const FIntVector MinCell = GetCellCoord(LocalBox.Min);
+	const FIntVector MaxCell = GetCellCoord(LocalBox.Max);
+	for (int32 Z = MinCell.Z; Z <= MaxCell.Z; Z++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+			{
+				const int32 CellIndex = X + (Y * Dims.X) + (Z * Dims.X * Dims.Y);
+				const int32 Start = CellStarts[CellIndex];
+				const int32 Count = CellStarts[CellIndex + 1] - Start;
+				if (Count > 0) Visitor(FIntVector(X, Y, Z), TArrayView<const int32>(PointIndices.GetData() + Start, Count));
+			}
+		}
+	}
+}
+
+// Tests a local space box against the region's planes with its nearest and furthest corner along each plane normal.
+static void SGClassifyBoxAgainstPlanes(const FBox& Box, TConstArrayView<FVector4> Planes, bool& bOutOutside, bool& bOutInside)
+{
+	bOutOutside = false;
+	bOutInside = true;
+	for (const FVector4& Plane : Planes)
+	{
+		const FVector Far(Plane.X >= 0.0 ? Box.Max.X : Box.Min.X, Plane.Y >= 0.0 ? Box.Max.Y : Box.Min.Y, Plane.Z >= 0.0 ? Box.Max.Z : Box.Min.Z);
+		const FVector Near(Plane.X >= 0.0 ? Box.Min.X : Box.Max.X, Plane.Y >= 0.0 ? Box.Min.Y : Box.Max.Y, Plane.Z >= 0.0 ? Box.Min.Z : Box.Max.Z);
+		if (Plane.X * Far.X + Plane.Y * Far.Y + Plane.Z * Far.Z + Plane.W < 0.0)
+		{
+			bOutOutside = true;
+			bOutInside = false;
+			return;
+		}
+		if (Plane.X * Near.X + Plane.Y * Near.Y + Plane.Z * Near.Z + Plane.W < 0.0) bOutInside = false;
+	}
+}
+
+void FSGControlPointGrid::ForEachCellInRegion(TConstArrayView<FVector4> Planes, TFunctionRef<void(const FIntVector&, TArrayView<const int32>)> Visitor) const
+{
+	if (Num() == 0) return;
+	VisitRegionBlock(FIntVector(0), Dims, Planes, Visitor);
+}
+
+void FSGControlPointGrid::VisitRegionBlock(const FIntVector& MinCell, const FIntVector& MaxCell, TConstArrayView<FVector4> Planes, TFunctionRef<void(const FIntVector&, TArrayView<const int32>)> Visitor) const
+{
+	// Cells MinCell up to, not including, MaxCell.
+	const FBox Box(Origin + FVector(MinCell) * CellSize, Origin + FVector(MaxCell) * CellSize);
+	bool bOutside, bInside;
+	SGClassifyBoxAgainstPlanes(Box, Planes, bOutside, bInside);
+	if (bOutside) return;
+	const FIntVector Size = MaxCell - MinCell;
+	if (bInside || Size.X * Size.Y * Size.Z == 1)
+	{
+		VisitCells(MinCell, MaxCell, Visitor);
+		return;
+	}
+
+	// Halve the longest side.
+	const int32 Axis = Size.X >= Size.Y && Size.X >= Size.Z ? 0 : (Size.Y >= Size.Z ? 1 : 2);
+	FIntVector SplitMax = MaxCell;
+	FIntVector SplitMin = MinCell;
+	SplitMax[Axis] = MinCell[Axis] + Size[Axis] / 2;
+	SplitMin[Axis] = SplitMax[Axis];
+	VisitRegionBlock(MinCell, SplitMax, Planes, Visitor);
+	VisitRegionBlock(SplitMin, MaxCell, Planes, Visitor);
+}
+
+void FSGControlPointGrid::VisitCells(const FIntVector& MinCell, const FIntVector& MaxCell, TFunctionRef<void(const FIntVector&, TArrayView<const int32>)> Visitor) const
+{
+	for (int32 Z = MinCell.Z; Z < MaxCell.Z; Z++)
+	{
+		for (int32 Y = MinCell.Y; Y < MaxCell.Y; Y++)
+		{
+			for (int32 X = MinCell.X; X < MaxCell.X; X++)
+			{
+				const int32 CellIndex = X + (Y * Dims.X) + (Z * Dims.X * Dims.Y);
+				const int32 Start = CellStarts[CellIndex];
+				const int32 Count = CellStarts[CellIndex + 1] - Start;
+				if (Count > 0) Visitor(FIntVector(X, Y, Z), TArrayView<const int32>(PointIndices.GetData() + Start, Count));
+			}
+		}
+	}
+}
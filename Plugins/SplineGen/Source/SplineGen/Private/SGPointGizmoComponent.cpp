@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SGPointGizmoComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Algo/BinarySearch.h"
+
+USGPointGizmoComponent::USGPointGizmoComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	SetCollisionProfileName(UCollisionProfile::NoCollision_ProfileName);
+	SetCastShadow(false);
+	NumCustomDataFloats = 1;
+}
+
+void USGPointGizmoComponent::SyncToSpline(bool bForceAll)
+{
+	if (!Spline) return;
+	const FInterpCurveVector& Position = Spline->SplineCurves.Position;
+	const int NumPoints = FMath::Min(Position.Points.Num(), Spline->SplineCurves.Rotation.Points.Num());
+
+	// Instances live in this component's space, points in the spline's. Moving either relative to the other dirties everything.
+	const FTransform SplineToGizmo = Spline->GetComponentTransform().GetRelativeTransform(GetComponentTransform());
+	if (!SplineToGizmo.Equals(CachedSplineToGizmo, 0.f)) bForceAll = true;
+	CachedSplineToGizmo = SplineToGizmo;
+
+	const int PreviousNum = GetInstanceCount();
+	if (NumPoints < PreviousNum)
+	{
+		TArray<int32> InstancesToRemove;
+		for (int i = NumPoints; i < PreviousNum; i++) InstancesToRemove.Emplace(i);
+		RemoveInstances(InstancesToRemove);
+	}
+	else if (NumPoints > PreviousNum)
+	{
+		TArray<FTransform> NewInstances;
+		NewInstances.SetNum(NumPoints - PreviousNum);
+		AddInstances(NewInstances, false, false);
+	}
+	CachedPoints.SetNum(NumPoints);
+
+	bool bAnyChanged = false;
+	for (int i = 0; i < NumPoints; i++)
+	{
+		// The track's own frame at the point's key. In the baked up vector modes it depends on the points before this one too, so it's compared rather than the point's inputs.
+		const FVector& Location = Position.Points[i].OutVal;
+		const FQuat Frame = Spline->GetCorrectQuaternionAtSplineInputKey(float(i), ESplineCoordinateSpace::Local);
+		FPointState& Cached = CachedPoints[i];
+		const bool bIsNew = i >= PreviousNum;
+		if (!bForceAll && !bIsNew && Cached.Location == Location && Cached.Frame.Equals(Frame, 0.f)) continue;
+
+		Cached.Location = Location;
+		Cached.Frame = Frame;
+		const FTransform InstanceTransform = FTransform(Frame, Location, FVector(GizmoScale)) * SplineToGizmo;
+		UpdateInstanceTransform(i, InstanceTransform, false, false, true);
+		if (bIsNew) SetPointState(i, false);
+		bAnyChanged = true;
+	}
+	if (bAnyChanged) MarkRenderStateDirty();
+}
+
+int USGPointGizmoComponent::PickPoint(FVector RayOrigin, FVector RayDirection, float MaxDistance) const
+{
+	if (!Spline) return -1;
+	const FVector Direction = RayDirection.GetSafeNormal();
+	const float RadiusSq = FMath::Square(PickRadius * GizmoScale);
+	int BestPoint = -1;
+	float BestDistance = MaxDistance;
+
+	// Cached locations are in the spline's space, so picking follows the actor without a SyncToSpline. Points are moved to world space
+	// rather than the ray to local space, which keeps the pick spheres round under non-uniform scale.
+	const FMatrix SplineToWorld = Spline->GetComponentTransform().ToMatrixWithScale();
+	for (int i = 0; i < CachedPoints.Num(); i++)
+	{
+		const FVector ToPoint = SplineToWorld.TransformPosition(CachedPoints[i].Location) - RayOrigin;
+		const float Along = FVector::DotProduct(ToPoint, Direction);
+		if (Along < 0.f || Along > BestDistance) continue;
+		if ((ToPoint - (Direction * Along)).SizeSquared() > RadiusSq) continue;
+		BestDistance = Along;
+		BestPoint = i;
+	}
+	return BestPoint;
+}
+
+void USGPointGizmoComponent::SetHoveredPoint(int Point)
+{
+	if (Point == HoveredPoint) return;
+	const int PreviousHoveredPoint = HoveredPoint;
+	HoveredPoint = Point;
+	if (PreviousHoveredPoint >= 0 && PreviousHoveredPoint < GetInstanceCount()) SetPointState(PreviousHoveredPoint, false);
+	if (HoveredPoint >= 0 && HoveredPoint < GetInstanceCount()) SetPointState(HoveredPoint, false);
+	MarkRenderStateDirty();
+}
+
+int USGPointGizmoComponent::GetHoveredPoint() const
+{
+	return HoveredPoint;
+}
+
+void USGPointGizmoComponent::SetSelectedPoints(TArray<int> NewSelection)
+{
+	NewSelection.Sort();
+	TArray<int> PreviousSelection = MoveTemp(SelectedPoints);
+	SelectedPoints = MoveTemp(NewSelection);
+	for (int Point : PreviousSelection) if (Point >= 0 && Point < GetInstanceCount()) SetPointState(Point, false);
+	for (int Point : SelectedPoints) if (Point >= 0 && Point < GetInstanceCount()) SetPointState(Point, false);
+	MarkRenderStateDirty();
+}
+
+float USGPointGizmoComponent::GetPointState(int Point) const
+{
+	if (Point == HoveredPoint) return 1.f;
+	if (Algo::BinarySearch(SelectedPoints, Point) != INDEX_NONE) return 2.f;
+	return 0.f;
+}
+
+void USGPointGizmoComponent::SetPointState(int Point, bool bMarkRenderStateDirty)
+{
+	SetCustomDataValue(Point, 0, GetPointState(Point), bMarkRenderStateDirty);
+}
@@ -2,6 +2,56 @@
 
 
 #include "SGSplineComponent.h"
+#include "Async/ParallelFor.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/CustomVersion.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "UObject/ObjectSaveContext.h"
+#if WITH_EDITOR
+#include "DerivedDataCacheInterface.h"
+#endif
+#include "SGEasing.h"
+#include "Algo/BinarySearch.h"
+#include "SGSplineCursor.h"
+
+// Versions of the data USGSplineComponent serializes after its properties.
+struct FSGSplineCustomVersion
+{
+	enum Type
+	{
+		BeforeCustomVersionWasAdded = 0,
+		SerializedFrameTables = 1,
+
+		VersionPlusOne,
+		LatestVersion = VersionPlusOne - 1
+	};
+
+	static const FGuid GUID;
+};
+
+const FGuid FSGSplineCustomVersion::GUID(0x081566E0, 0xC34F415A, 0xA660B025, 0x03051250);
+static FCustomVersionRegistration GRegisterSGSplineCustomVersion(FSGSplineCustomVersion::GUID, FSGSplineCustomVersion::LatestVersion, TEXT("SGSplineVer"));
+
+// Change whenever the derived data or the way it's built changes, so stale serialized and cached data is rebuilt.
+static const TCHAR* SGDerivedDataVersion = TEXT("5C1D6A0E8B7F4E2A9C3B1D0F6E5A4B21");
+
+// Batched queries smaller than this aren't worth the task dispatch.
+static const int32 SGParallelBatchThreshold = 256;
+
+// Up projected onto the plane normal to Tangent, or any perpendicular if they're parallel.
+static FVector SGOrthogonalUp(const FVector& Up, const FVector& Tangent)
+{
+	const FVector Result = (Up - Tangent * FVector::DotProduct(Up, Tangent)).GetSafeNormal();
+	if (Result.IsNearlyZero()) return FRotationMatrix::MakeFromX(Tangent).GetUnitAxis(EAxis::Z);
+	return Result;
+}
+
+// Angle that rotates From onto To about Axis, with From perpendicular to Axis.
+static float SGSignedAngleAround(const FVector& From, const FVector& To, const FVector& Axis)
+{
+	return FMath::Atan2(FVector::DotProduct(Axis, FVector::CrossProduct(From, To)), FVector::DotProduct(From, To));
+}
 
 // Sets default values for this component's properties
 USGSplineComponent::USGSplineComponent()
@@ -19,8 +69,7 @@ void USGSplineComponent::BeginPlay()
 {
 	Super::BeginPlay();
 	SetComponentTickEnabled(false);
-	UpdateUpVectorSpline(true);
-	UpdateLocalOffsetPositionSpline();
+	// Derived data is built by the first query or by WarmUpDerivedData.
 	// ...
 	
 }
@@ -34,15 +83,1041 @@ void USGSplineComponent::TickComponent(float DeltaTime, ELevelTick TickType, FAc
 	// ...
 }
 
+void USGSplineComponent::UpdateSpline()
+{
+	Super::UpdateSpline();
+	SplineRevision++;
+	// Keeps position and scale queries on the coefficient cache between derived data builds.
+	UpdateCurveCoefficients();
+	// Exact and AdaptiveTable layouts wait for the arc length tables, which UpdateArcLengthTable lays out once they're built.
+	if (ArcLengthMode == ESGArcLengthMode::ReparamTable) UpdateSegmentLayouts();
+}
+
 void USGSplineComponent::UpdateSGSplines(bool bUpdateSplineFirst)
 {
-	UpdateUpVectorSpline(bUpdateSplineFirst);
-	if (bEnableSmoothTangentsForLocalOffset) UpdateLocalOffsetPositionSpline(bUpdateSplineFirst);
+	FScopeLock Lock(&DerivedDataLock);
+	const uint32 OuterBuildThreadId = DerivedDataBuildThreadId.exchange(FPlatformTLS::GetCurrentThreadId());
+
+	const bool bAdoptSerializedData = !bUpdateSplineFirst && bHasSerializedDerivedData && SerializedDerivedDataHash == ComputeDerivedDataHash();
+	if (bAdoptSerializedData)
+	{
+		// The loaded curves and frame tables are current; only rebuild the caches that are cheap to derive.
+		if (CurveCoefficientRevision != SplineRevision) UpdateCurveCoefficients();
+		UpdateUpVectorCoefficients();
+		UpdateArcLengthTable();
+		BakedFrameRevision = SplineRevision;
+		BakedFrameInputKey = ComputeFrameInputKey();
+	}
+	else
+	{
+		// The spline only needs updating once; a second UpdateSpline would leave the coefficient cache stale.
+		UpdateUpVectorSpline(bUpdateSplineFirst);
+		UpdateArcLengthTable();
+		UpdateFrameTable();
+		// The offset curve samples corrected frames, so it goes last.
+		if (bEnableLocalOffset && bEnableSmoothTangentsForLocalOffset) UpdateLocalOffsetPositionSpline(false);
+	}
+	// A build can change its own inputs, as a resampled roll channel does, so hash them again unless the loaded tables were adopted as they were.
+	BuiltDerivedDataHash = bAdoptSerializedData ? SerializedDerivedDataHash : ComputeDerivedDataHash();
+	bHasSerializedDerivedData = false;
+
+	DerivedDataInputKey = ComputeDerivedDataInputKey();
+	DerivedDataBuildThreadId.store(OuterBuildThreadId);
+	DerivedDataRevision.store(SplineRevision, std::memory_order_release);
+}
+
+void USGSplineComponent::WarmUpDerivedData()
+{
+	if (!IsDerivedDataValid()) UpdateSGSplines(false);
+}
+
+uint32 USGSplineComponent::ComputeFrameInputKey() const
+{
+	uint32 Key = GetTypeHash(uint8(UpVectorMode));
+	Key = HashCombine(Key, GetTypeHash(FramesPerSegment));
+	Key = HashCombine(Key, GetTypeHash(uint8(bCompressBakedFrames)));
+	Key = HashCombine(Key, GetTypeHash(RollChannelLoopTwist));
+	Key = HashCombine(Key, GetTypeHash(SegmentRollConfigs.Num()));
+	Key = HashCombine(Key, GetTypeHash(SplineCurveRoll.Points.Num()));
+	return HashCombine(Key, GetTypeHash(DerivedDataInputRevision));
+}
+
+uint32 USGSplineComponent::ComputeDerivedDataInputKey() const
+{
+	uint32 Key = HashCombine(ComputeFrameInputKey(), GetTypeHash(uint8(ArcLengthMode)));
+	Key = HashCombine(Key, GetTypeHash(AdaptiveReparamTolerance));
+	Key = HashCombine(Key, GetTypeHash(uint8(bEnableLocalOffset)));
+	Key = HashCombine(Key, GetTypeHash(uint8(bEnableSmoothTangentsForLocalOffset)));
+	// Only the offset curve reads these, and it's only built with both flags set.
+	if (bEnableLocalOffset && bEnableSmoothTangentsForLocalOffset)
+	{
+		Key = HashCombine(Key, GetTypeHash(LocalOffset));
+		Key = HashCombine(Key, GetTypeHash(TargetMeshLength));
+	}
+	return Key;
+}
+
+void USGSplineComponent::MarkDerivedDataInputsChanged()
+{
+	DerivedDataInputRevision++;
+}
+
+// Saving archives only read, but FArchive's operators take non-const references.
+template<typename ValueT>
+static void SGWriteHashInput(FArchive& Ar, const ValueT& Value)
+{
+	Ar << const_cast<ValueT&>(Value);
+}
+
+FSHAHash USGSplineComponent::ComputeDerivedDataHash() const
+{
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	SGWriteHashInput(Writer, FString(SGDerivedDataVersion));
+	SGWriteHashInput(Writer, SplineCurves.Position);
+	SGWriteHashInput(Writer, SplineCurves.Rotation);
+	SGWriteHashInput(Writer, SplineCurves.Scale);
+	SGWriteHashInput(Writer, SplineCurveRoll);
+	SGWriteHashInput(Writer, UpVectorMode);
+	SGWriteHashInput(Writer, ArcLengthMode);
+	SGWriteHashInput(Writer, AdaptiveReparamTolerance);
+	SGWriteHashInput(Writer, FramesPerSegment);
+	SGWriteHashInput(Writer, RollChannelLoopTwist);
+	SGWriteHashInput(Writer, TargetMeshLength);
+	SGWriteHashInput(Writer, LocalOffset);
+	// The arc length tables, and the offset curve placed along them, are built with the component scale.
+	SGWriteHashInput(Writer, GetComponentTransform().GetScale3D());
+	Writer << const_cast<bool&>(bCompressBakedFrames) << const_cast<bool&>(bEnableLocalOffset) << const_cast<bool&>(bEnableSmoothTangentsForLocalOffset);
+	for (const FRollConfig& RollConfig : SegmentRollConfigs)
+	{
+		SGWriteHashInput(Writer, RollConfig.EaseType);
+		SGWriteHashInput(Writer, RollConfig.InOut);
+		SGWriteHashInput(Writer, RollConfig.EaseExp);
+	}
+
+	FSHAHash Hash;
+	FSHA1::HashBuffer(Bytes.GetData(), Bytes.Num(), Hash.Hash);
+	return Hash;
+}
+
+bool USGSplineComponent::SerializeDerivedData(FArchive& Ar)
+{
+	if (!Ar.IsLoading())
+	{
+		Ar << SplineCurveUpVector;
+		Ar << SplineCurveLocalOffsetPosition;
+		Ar << LocalOffsetSplineSegmentLength << OffsetSplineEstimatedLength;
+		BakedFrames.Serialize(Ar);
+		CompressedFrames.Serialize(Ar);
+		return !Ar.IsError();
+	}
+
+	// Read into copies first, so a damaged blob leaves the current data as it was.
+	FInterpCurveVector UpVector;
+	FInterpCurveVector LocalOffsetPosition;
+	float SegmentLength = 0.f;
+	float EstimatedLength = 0.f;
+	FSGFrameTable Frames;
+	FSGCompressedFrameTable Compressed;
+	Ar << UpVector;
+	Ar << LocalOffsetPosition;
+	Ar << SegmentLength << EstimatedLength;
+	Frames.Serialize(Ar);
+	Compressed.Serialize(Ar);
+	if (Ar.IsError()) return false;
+
+	SplineCurveUpVector = MoveTemp(UpVector);
+	SplineCurveLocalOffsetPosition = MoveTemp(LocalOffsetPosition);
+	LocalOffsetSplineSegmentLength = SegmentLength;
+	OffsetSplineEstimatedLength = EstimatedLength;
+	BakedFrames = MoveTemp(Frames);
+	CompressedFrames = MoveTemp(Compressed);
+	return true;
+}
+
+void USGSplineComponent::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+	Ar.UsingCustomVersion(FSGSplineCustomVersion::GUID);
+	if (Ar.CustomVer(FSGSplineCustomVersion::GUID) < FSGSplineCustomVersion::SerializedFrameTables || Ar.IsTransacting()) return;
+
+	// The curves are properties already; only the tables and the hash they were built for go here.
+	bool bHasData = false;
+	if (Ar.IsSaving())
+	{
+		// The hash the tables were built for, not one of the current properties, which may have changed since without the tables being rebuilt.
+		if (IsDerivedDataValid()) SerializedDerivedDataHash = BuiltDerivedDataHash;
+		bHasData = IsDerivedDataValid() || bHasSerializedDerivedData;
+	}
+	Ar << bHasData;
+	if (bHasData)
+	{
+		Ar << SerializedDerivedDataHash;
+		BakedFrames.Serialize(Ar);
+		CompressedFrames.Serialize(Ar);
+	}
+	if (Ar.IsLoading()) bHasSerializedDerivedData = bHasData;
+}
+
+#if WITH_EDITOR
+void USGSplineComponent::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+	// Edits inside these arrays don't change their size, so the input keys can't see them.
+	const FName PropertyName = PropertyChangedEvent.GetMemberPropertyName();
+	if (PropertyName == GET_MEMBER_NAME_CHECKED(USGSplineComponent, SegmentRollConfigs) || PropertyName == GET_MEMBER_NAME_CHECKED(USGSplineComponent, SplineCurveRoll))
+	{
+		MarkDerivedDataInputsChanged();
+	}
+}
+
+void USGSplineComponent::PreSave(FObjectPreSaveContext SaveContext)
+{
+	Super::PreSave(SaveContext);
+	BuildDerivedDataThroughDDC();
+}
+
+void USGSplineComponent::BeginCacheForCookedPlatformData(const ITargetPlatform* TargetPlatform)
+{
+	Super::BeginCacheForCookedPlatformData(TargetPlatform);
+	BuildDerivedDataThroughDDC();
+}
+
+void USGSplineComponent::BuildDerivedDataThroughDDC()
+{
+	if (HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject) || IsDerivedDataValid()) return;
+
+	// Another save or cook of the same inputs may have built the data already.
+	const FSHAHash Hash = ComputeDerivedDataHash();
+	const FString CacheKey = FDerivedDataCacheInterface::BuildCacheKey(TEXT("SGSPLINE"), SGDerivedDataVersion, *Hash.ToString());
+	TArray<uint8> Blob;
+	if (GetDerivedDataCacheRef().GetSynchronous(*CacheKey, Blob, GetPathName()))
+	{
+		FMemoryReader Reader(Blob);
+		if (SerializeDerivedData(Reader))
+		{
+			SerializedDerivedDataHash = Hash;
+			bHasSerializedDerivedData = true;
+			UpdateSGSplines(false);
+			return;
+		}
+		Blob.Reset();
+	}
+
+	UpdateSGSplines(false);
+	FMemoryWriter Writer(Blob);
+	SerializeDerivedData(Writer);
+	GetDerivedDataCacheRef().Put(*CacheKey, Blob, GetPathName());
+}
+#endif
+
+void USGSplineComponent::EnsureDerivedData() const
+{
+	if (IsDerivedDataValid() || DerivedDataBuildThreadId.load() == FPlatformTLS::GetCurrentThreadId()) return;
+	FScopeLock Lock(&DerivedDataLock);
+	if (!IsDerivedDataValid()) const_cast<USGSplineComponent*>(this)->UpdateSGSplines(false);
+}
+
+// Order 5 Gauss-Legendre nodes and weights on [-1,1].
+static const double SGGaussLegendreNodes[5] = { -0.9061798459386640, -0.5384693101056831, 0.0, 0.5384693101056831, 0.9061798459386640 };
+static const double SGGaussLegendreWeights[5] = { 0.2369268850561891, 0.4786286704993665, 0.5688888888888889, 0.4786286704993665, 0.2369268850561891 };
+
+double USGSplineComponent::IntegrateSegmentLength(int Segment, double T, int SubIntervals) const
+{
+	return IntegrateSegmentRange(Segment, 0.0, T, SubIntervals);
+}
+
+double USGSplineComponent::IntegrateSegmentRange(int Segment, double T0, double T1, int SubIntervals) const
+{
+	const FSGCubicSegment& Cubic = PositionSegments[Segment];
+	const FVector& Scale3D = ArcLengthScale3D;
+	const double Step = (T1 - T0) / SubIntervals;
+	double Length = 0.0;
+	for (int Interval = 0; Interval < SubIntervals; Interval++)
+	{
+		const double Mid = T0 + (Interval + 0.5) * Step;
+		for (int i = 0; i < 5; i++)
+		{
+			Length += SGGaussLegendreWeights[i] * (Cubic.EvalDerivative(Mid + 0.5 * Step * SGGaussLegendreNodes[i]) * Scale3D).Size();
+		}
+	}
+	return Length * 0.5 * Step;
+}
+
+void USGSplineComponent::UpdateArcLengthTable()
+{
+	BuildArcLengthTables();
+	UpdateSegmentLayouts();
+}
+
+FSGSegmentLayout USGSplineComponent::ComputeSegmentLayout(int Segment) const
+{
+	FSGSegmentLayout Layout;
+	const int NumSegments = GetNumberOfSplineSegments();
+	if (Segment < 0 || Segment >= NumSegments) return Layout;
+
+	if (UsesExactArcLengths())
+	{
+		Layout.StartDistance = float(ExactSegmentDistances[Segment]);
+		Layout.Length = float(ExactSegmentDistances[Segment + 1] - ExactSegmentDistances[Segment]);
+	}
+	else
+	{
+		Layout.StartDistance = GetDistanceAlongSplineAtSplinePoint(Segment);
+		const float EndDistance = Segment + 1 < NumSegments ? GetDistanceAlongSplineAtSplinePoint(Segment + 1) : GetSplineLength();
+		Layout.Length = FMath::Max(EndDistance - Layout.StartDistance, 0.f);
+	}
+	if (Layout.Length > 0.f && TargetMeshLength > 0.f)
+	{
+		Layout.PieceCount = FMath::Max(FMath::RoundToInt(Layout.Length / TargetMeshLength), 1);
+		Layout.PieceLength = Layout.Length / Layout.PieceCount;
+	}
+	return Layout;
+}
+
+void USGSplineComponent::UpdateSegmentLayouts()
+{
+	// Always a full pass: each layout is a couple of lookups into tables that were themselves rebuilt in full, and a length change moves every later start distance anyway.
+	const int NumSegments = GetNumberOfSplineSegments();
+	SegmentLayouts.SetNum(NumSegments);
+	for (int Segment = 0; Segment < NumSegments; Segment++) SegmentLayouts[Segment] = ComputeSegmentLayout(Segment);
+	SegmentLayoutRevision = SplineRevision;
+	SegmentLayoutTargetMeshLength = TargetMeshLength;
+	bSegmentLayoutsUseExactLengths = UsesExactArcLengths();
+}
+
+FSGSegmentLayout USGSplineComponent::GetSegmentLayout(int Segment) const
+{
+	EnsureDerivedData();
+	if (HasSegmentLayouts() && SegmentLayouts.IsValidIndex(Segment)) return SegmentLayouts[Segment];
+	return ComputeSegmentLayout(Segment);
+}
+
+void USGSplineComponent::BuildArcLengthTables()
+{
+	ExactSegmentDistances.Reset();
+	AdaptiveReparamDistances.Reset();
+	AdaptiveReparamKeys.Reset();
+	AdaptiveReparamBuckets.Reset();
+	if (ArcLengthMode == ESGArcLengthMode::ReparamTable) return;
+	if (CurveCoefficientRevision != SplineRevision) UpdateCurveCoefficients();
+	const int NumSegments = PositionSegments.Num();
+	if (NumSegments < 1) return;
+	// Like the reparam table, the tables keep the scale they were built with until the next build.
+	ArcLengthScale3D = GetComponentTransform().GetScale3D();
+
+	ExactSegmentDistances.SetNumUninitialized(NumSegments + 1);
+	ParallelFor(NumSegments, [&](int32 Segment)
+	{
+		ExactSegmentDistances[Segment + 1] = IntegrateSegmentLength(Segment, 1.0);
+	}, NumSegments < SGParallelBatchThreshold ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+	ExactSegmentDistances[0] = 0.0;
+	for (int Segment = 1; Segment <= NumSegments; Segment++) ExactSegmentDistances[Segment] += ExactSegmentDistances[Segment - 1];
+	ArcLengthRevision = SplineRevision;
+	if (ArcLengthMode != ESGArcLengthMode::AdaptiveTable) return;
+
+	// Segments subdivide independently, then concatenate behind the shared start sample.
+	TArray<TArray<double>> SegmentDistances;
+	TArray<TArray<float>> SegmentKeys;
+	SegmentDistances.SetNum(NumSegments);
+	SegmentKeys.SetNum(NumSegments);
+	ParallelFor(NumSegments, [&](int32 Segment)
+	{
+		BuildAdaptiveReparamSegment(Segment, SegmentDistances[Segment], SegmentKeys[Segment]);
+	}, NumSegments < 8 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	int NumSamples = 1;
+	for (const TArray<float>& Keys : SegmentKeys) NumSamples += Keys.Num();
+	AdaptiveReparamDistances.Reserve(NumSamples);
+	AdaptiveReparamKeys.Reserve(NumSamples);
+	AdaptiveReparamDistances.Add(0.0);
+	AdaptiveReparamKeys.Add(0.f);
+	for (int Segment = 0; Segment < NumSegments; Segment++)
+	{
+		const double SegmentStart = ExactSegmentDistances[Segment];
+		for (int i = 0; i < SegmentKeys[Segment].Num(); i++)
+		{
+			AdaptiveReparamDistances.Add(SegmentStart + SegmentDistances[Segment][i]);
+			AdaptiveReparamKeys.Add(SegmentKeys[Segment][i]);
+		}
+	}
+
+	// Uniform buckets over distance, each pointing at the last sample at or before its start, so a lookup only walks the few samples inside one bucket.
+	const double TotalLength = AdaptiveReparamDistances.Last();
+	const int NumBuckets = FMath::Max(NumSamples - 1, 1);
+	AdaptiveReparamBucketSize = TotalLength > 0.0 ? TotalLength / NumBuckets : 1.0;
+	AdaptiveReparamBuckets.SetNumUninitialized(NumBuckets);
+	int Sample = 0;
+	for (int Bucket = 0; Bucket < NumBuckets; Bucket++)
+	{
+		const double BucketStart = Bucket * AdaptiveReparamBucketSize;
+		while (Sample < NumSamples - 2 && AdaptiveReparamDistances[Sample + 1] <= BucketStart) Sample++;
+		AdaptiveReparamBuckets[Bucket] = Sample;
+	}
+}
+
+void USGSplineComponent::BuildAdaptiveReparamSegment(int Segment, TArray<double>& OutDistances, TArray<float>& OutKeys) const
+{
+	// Split at least MinDepth times so symmetric curvature can't hide from the midpoint test, and at most MaxDepth times.
+	const int MinDepth = 2;
+	const int MaxDepth = 12;
+	const double Tolerance = FMath::Max(double(AdaptiveReparamTolerance), 0.001);
+	struct FInterval { double T0; double D0; double T1; double D1; int Depth; };
+	TArray<FInterval, TInlineAllocator<32>> Stack;
+	Stack.Push({ 0.0, 0.0, 1.0, ExactSegmentDistances[Segment + 1] - ExactSegmentDistances[Segment], 0 });
+	while (Stack.Num() > 0)
+	{
+		const FInterval Interval = Stack.Pop(EAllowShrinking::No);
+		const double MidT = 0.5 * (Interval.T0 + Interval.T1);
+		const double MidD = Interval.D0 + IntegrateSegmentRange(Segment, Interval.T0, MidT);
+		const double Error = FMath::Abs(MidD - 0.5 * (Interval.D0 + Interval.D1));
+		if (Interval.Depth < MinDepth || (Interval.Depth < MaxDepth && Error > Tolerance))
+		{
+			// Second half first, so the first half pops next and samples come out in order.
+			Stack.Push({ MidT, MidD, Interval.T1, Interval.D1, Interval.Depth + 1 });
+			Stack.Push({ Interval.T0, Interval.D0, MidT, MidD, Interval.Depth + 1 });
+			continue;
+		}
+		OutDistances.Add(Interval.D1);
+		OutKeys.Add(float(Segment + Interval.T1));
+	}
+}
+
+float USGSplineComponent::GetAdaptiveInputKeyAtDistance(float Distance) const
+{
+	const int NumSamples = AdaptiveReparamKeys.Num();
+	const double Target = FMath::Clamp(double(Distance), 0.0, AdaptiveReparamDistances.Last());
+	const int Bucket = FMath::Clamp(int(Target / AdaptiveReparamBucketSize), 0, AdaptiveReparamBuckets.Num() - 1);
+	int Sample = AdaptiveReparamBuckets[Bucket];
+	while (Sample < NumSamples - 2 && AdaptiveReparamDistances[Sample + 1] <= Target) Sample++;
+	const double Span = AdaptiveReparamDistances[Sample + 1] - AdaptiveReparamDistances[Sample];
+	const float Alpha = Span > UE_SMALL_NUMBER ? float((Target - AdaptiveReparamDistances[Sample]) / Span) : 0.f;
+	return FMath::Lerp(AdaptiveReparamKeys[Sample], AdaptiveReparamKeys[Sample + 1], Alpha);
+}
+
+float USGSplineComponent::GetExactInputKeyAtDistance(float Distance) const
+{
+	const int NumSegments = ExactSegmentDistances.Num() - 1;
+	const double Target = FMath::Clamp(double(Distance), 0.0, ExactSegmentDistances.Last());
+	const int Segment = FMath::Clamp(int(Algo::UpperBound(ExactSegmentDistances, Target)) - 1, 0, NumSegments - 1);
+	const double SegmentStart = ExactSegmentDistances[Segment];
+	const double SegmentLength = ExactSegmentDistances[Segment + 1] - SegmentStart;
+	if (SegmentLength <= UE_SMALL_NUMBER) return float(Segment);
+
+	const double LocalTarget = Target - SegmentStart;
+	return float(Segment + SolveExactSegmentT(Segment, LocalTarget, LocalTarget / SegmentLength));
+}
+
+double USGSplineComponent::SolveExactSegmentT(int Segment, double LocalTarget, double GuessT) const
+{
+	// The speed is the derivative of length, so Newton converges in a few steps from a linear guess.
+	const FVector& Scale3D = ArcLengthScale3D;
+	double T = FMath::Clamp(GuessT, 0.0, 1.0);
+	for (int Iteration = 0; Iteration < 4; Iteration++)
+	{
+		const double Error = IntegrateSegmentLength(Segment, T) - LocalTarget;
+		if (FMath::Abs(Error) < 1e-3) break;
+		const double Speed = (PositionSegments[Segment].EvalDerivative(T) * Scale3D).Size();
+		if (Speed <= UE_SMALL_NUMBER) break;
+		T = FMath::Clamp(T - Error / Speed, 0.0, 1.0);
+	}
+	return T;
+}
+
+float USGSplineComponent::GetCorrectInputKeyAtDistanceAlongSpline(float Distance) const
+{
+	EnsureDerivedData();
+	if (ArcLengthMode == ESGArcLengthMode::Exact && HasExactArcLengths()) return GetExactInputKeyAtDistance(Distance);
+	if (ArcLengthMode == ESGArcLengthMode::AdaptiveTable && HasAdaptiveReparamTable()) return GetAdaptiveInputKeyAtDistance(Distance);
+	return SplineCurves.ReparamTable.Eval(Distance, 0.0f);
+}
+
+float USGSplineComponent::GetCorrectSplineLength() const
+{
+	EnsureDerivedData();
+	if (ArcLengthMode == ESGArcLengthMode::ReparamTable || !HasExactArcLengths()) return GetSplineLength();
+	return float(ExactSegmentDistances.Last());
+}
+
+float USGSplineComponent::GetCorrectDistanceAlongSplineAtSplineInputKey(float InKey) const
+{
+	EnsureDerivedData();
+	if (ArcLengthMode == ESGArcLengthMode::ReparamTable || !HasExactArcLengths()) return GetDistanceAlongSplineAtSplineInputKey(InKey);
+	int Segment;
+	double T;
+	LocateCurveSegment(PositionSegments, InKey, Segment, T);
+	return float(ExactSegmentDistances[Segment] + IntegrateSegmentLength(Segment, T));
+}
+
+FSGArcLengthBenchmarkResult USGSplineComponent::BenchmarkArcLengthModes(int NumQueries)
+{
+	FSGArcLengthBenchmarkResult Result;
+	const ESGArcLengthMode PreviousMode = ArcLengthMode;
+	ArcLengthMode = ESGArcLengthMode::Exact;
+	if (!HasExactArcLengths()) UpdateArcLengthTable();
+	if (!HasExactArcLengths() || NumQueries < 1)
+	{
+		ArcLengthMode = PreviousMode;
+		return Result;
+	}
+
+	const double TotalLength = ExactSegmentDistances.Last();
+	TArray<float> Distances;
+	Distances.SetNumUninitialized(NumQueries);
+	for (int i = 0; i < NumQueries; i++) Distances[i] = float(TotalLength * (i + 0.5) / NumQueries);
+	TArray<float> TableKeys;
+	TArray<float> ExactKeys;
+	TableKeys.SetNumUninitialized(NumQueries);
+	ExactKeys.SetNumUninitialized(NumQueries);
+
+	double StartTime = FPlatformTime::Seconds();
+	for (int i = 0; i < NumQueries; i++) TableKeys[i] = SplineCurves.ReparamTable.Eval(Distances[i], 0.0f);
+	const double TableSeconds = FPlatformTime::Seconds() - StartTime;
+	StartTime = FPlatformTime::Seconds();
+	for (int i = 0; i < NumQueries; i++) ExactKeys[i] = GetExactInputKeyAtDistance(Distances[i]);
+	const double ExactSeconds = FPlatformTime::Seconds() - StartTime;
+
+	// Errors are measured against a much finer quadrature than either mode uses, with prefix sums so each sample only integrates its own segment.
+	TArray<double> ReferenceStarts;
+	ReferenceStarts.SetNumUninitialized(PositionSegments.Num() + 1);
+	ReferenceStarts[0] = 0.0;
+	for (int i = 0; i < PositionSegments.Num(); i++) ReferenceStarts[i + 1] = ReferenceStarts[i] + IntegrateSegmentLength(i, 1.0, 16);
+	auto KeyError = [this, &ReferenceStarts](float Key, float Distance)
+	{
+		int Segment;
+		double T;
+		LocateCurveSegment(PositionSegments, Key, Segment, T);
+		return float(FMath::Abs(ReferenceStarts[Segment] + IntegrateSegmentLength(Segment, T, 16) - Distance));
+	};
+
+	double TableErrorSum = 0.0;
+	double ExactErrorSum = 0.0;
+	for (int i = 0; i < NumQueries; i++)
+	{
+		const float TableError = KeyError(TableKeys[i], Distances[i]);
+		const float ExactError = KeyError(ExactKeys[i], Distances[i]);
+		TableErrorSum += TableError;
+		ExactErrorSum += ExactError;
+		Result.TableMaxError = FMath::Max(Result.TableMaxError, TableError);
+		Result.ExactMaxError = FMath::Max(Result.ExactMaxError, ExactError);
+	}
+	Result.NumQueries = NumQueries;
+	Result.TableMeanError = float(TableErrorSum / NumQueries);
+	Result.ExactMeanError = float(ExactErrorSum / NumQueries);
+	Result.TableQueriesPerSecond = TableSeconds > 0.0 ? float(NumQueries / TableSeconds) : 0.f;
+	Result.ExactQueriesPerSecond = ExactSeconds > 0.0 ? float(NumQueries / ExactSeconds) : 0.f;
+	UE_LOG(LogTemp, Display, TEXT("Arc length benchmark (%i queries): table %.0f q/s, mean error %f, max error %f; exact %.0f q/s, mean error %f, max error %f"),
+		NumQueries, Result.TableQueriesPerSecond, Result.TableMeanError, Result.TableMaxError, Result.ExactQueriesPerSecond, Result.ExactMeanError, Result.ExactMaxError);
+
+	ArcLengthMode = PreviousMode;
+	if (ArcLengthMode == ESGArcLengthMode::ReparamTable) ExactSegmentDistances.Reset();
+	return Result;
+}
+
+FSGCubicSegment FSGCubicSegment::FromCurvePoints(const FInterpCurvePoint<FVector>& P0, const FInterpCurvePoint<FVector>& P1, float KeySpan)
+{
+	FSGCubicSegment Segment;
+	Segment.D = P0.OutVal;
+	if (P0.InterpMode == CIM_Constant) return Segment;
+	if (P0.InterpMode == CIM_Linear)
+	{
+		Segment.C = P1.OutVal - P0.OutVal;
+		return Segment;
+	}
+	// Hermite basis expanded into powers of T.
+	const FVector T0 = P0.LeaveTangent * KeySpan;
+	const FVector T1 = P1.ArriveTangent * KeySpan;
+	Segment.A = 2.0 * P0.OutVal + T0 - 2.0 * P1.OutVal + T1;
+	Segment.B = -3.0 * P0.OutVal - 2.0 * T0 + 3.0 * P1.OutVal - T1;
+	Segment.C = T0;
+	return Segment;
+}
+
+static void SGBuildCubicSegments(const FInterpCurveVector& Curve, FSGCubicSegmentArray& OutSegments)
+{
+	const int NumPoints = Curve.Points.Num();
+	const int NumSegments = NumPoints < 2 ? 0 : (Curve.bIsLooped ? NumPoints : NumPoints - 1);
+	OutSegments.SetNumUninitialized(NumSegments);
+	for (int i = 0; i < NumSegments; i++)
+	{
+		const bool bClosingSegment = i == NumPoints - 1;
+		const FInterpCurvePoint<FVector>& P0 = Curve.Points[i];
+		const FInterpCurvePoint<FVector>& P1 = Curve.Points[bClosingSegment ? 0 : i + 1];
+		const float KeySpan = bClosingSegment ? Curve.LoopKeyOffset : P1.InVal - P0.InVal;
+		OutSegments[i] = FSGCubicSegment::FromCurvePoints(P0, P1, KeySpan);
+	}
+}
+
+void USGSplineComponent::UpdateCurveCoefficients()
+{
+	SGBuildCubicSegments(SplineCurves.Position, PositionSegments);
+	SGBuildCubicSegments(SplineCurves.Scale, ScaleSegments);
+	CurveCoefficientRevision = SplineRevision;
+}
+
+void USGSplineComponent::UpdateUpVectorCoefficients()
+{
+	SGBuildCubicSegments(SplineCurveUpVector, UpVectorSegments);
+	UpVectorCoefficientRevision = SplineRevision;
+}
+
+bool USGSplineComponent::LocateCurveSegment(const FSGCubicSegmentArray& Segments, float InKey, int& OutSegment, double& OutT) const
+{
+	if (Segments.Num() == 0) return false;
+	OutSegment = FMath::Clamp(FMath::FloorToInt(InKey), 0, Segments.Num() - 1);
+	OutT = FMath::Clamp(double(InKey) - OutSegment, 0.0, 1.0);
+	return true;
+}
+
+FVector USGSplineComponent::EvalPosition(float InKey) const
+{
+	int Segment;
+	double T;
+	if (CurveCoefficientRevision == SplineRevision && LocateCurveSegment(PositionSegments, InKey, Segment, T)) return PositionSegments[Segment].Eval(T);
+	return SplineCurves.Position.Eval(InKey, FVector::ZeroVector);
+}
+
+FVector USGSplineComponent::EvalPositionDerivative(float InKey) const
+{
+	int Segment;
+	double T;
+	if (CurveCoefficientRevision == SplineRevision && LocateCurveSegment(PositionSegments, InKey, Segment, T)) return PositionSegments[Segment].EvalDerivative(T);
+	return SplineCurves.Position.EvalDerivative(InKey, FVector::ZeroVector);
+}
+
+FVector USGSplineComponent::EvalUpVector(float InKey) const
+{
+	int Segment;
+	double T;
+	if (UpVectorCoefficientRevision == SplineRevision && LocateCurveSegment(UpVectorSegments, InKey, Segment, T)) return UpVectorSegments[Segment].Eval(T);
+	return SplineCurveUpVector.Eval(InKey, FVector::UpVector);
+}
+
+FVector USGSplineComponent::EvalScale(float InKey) const
+{
+	int Segment;
+	double T;
+	if (CurveCoefficientRevision == SplineRevision && LocateCurveSegment(ScaleSegments, InKey, Segment, T)) return ScaleSegments[Segment].Eval(T);
+	return SplineCurves.Scale.Eval(InKey, FVector(1.0f));
+}
+
+void USGSplineComponent::UpdateFrameTable(bool bUpdateSplineFirst)
+{
+	if (bUpdateSplineFirst) UpdateSpline();
+	BakedFrames.Reset();
+	CompressedFrames.Reset();
+	const int NumSegments = GetNumberOfSplineSegments();
+	const int NumPoints = SplineCurves.Rotation.Points.Num();
+	if (UpVectorMode == ESGUpVectorMode::HermiteCurve || NumSegments < 1 || NumPoints < 1) return;
+
+	const int SamplesPerSegment = FMath::Max(FramesPerSegment, 1);
+	TArray<FVector> Tangents;
+	TArray<FVector> Ups;
+	BuildReferenceFrames(SamplesPerSegment, Tangents, Ups);
+	const int NumSamples = Tangents.Num();
+
+	TArray<float> Rolls;
+	if (UpVectorMode == ESGUpVectorMode::NoRoll)
+	{
+		Rolls.SetNumZeroed(NumSamples);
+	}
+	else if (UpVectorMode == ESGUpVectorMode::RollChannel)
+	{
+		if (SplineCurveRoll.Points.Num() == 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("RollChannel mode with an empty SplineCurveRoll. Seeding it from the point rotations."));
+			ConvertUpVectorCurveToRollChannel(false);
+			return;
+		}
+		if (SplineCurveRoll.Points.Num() != NumPoints) ResampleRollChannel();
+		Rolls.SetNumUninitialized(NumSamples);
+		const float KeyStep = 1.f / float(SamplesPerSegment);
+		const float LoopTwistPerKey = IsClosedLoop() ? FMath::DegreesToRadians(RollChannelLoopTwist) / float(NumSegments) : 0.f;
+		for (int i = 0; i < NumSamples; i++)
+		{
+			const float Key = i * KeyStep;
+			Rolls[i] = FMath::DegreesToRadians(SplineCurveRoll.Eval(Key, 0.f)) + LoopTwistPerKey * Key;
+		}
+	}
+	else
+	{
+		Rolls.SetNumUninitialized(NumSamples);
+		TArray<float> PointRolls;
+		ComputeAuthoredPointRolls(SamplesPerSegment, Tangents, Ups, PointRolls);
+
+		// Ease the roll across each segment with its config resolved once.
+		TArray<float> Alphas;
+		Alphas.SetNumUninitialized(SamplesPerSegment);
+		for (int Segment = 0; Segment < NumSegments; Segment++)
+		{
+			const FSGEasing Easing(SegmentRollConfigs.IsValidIndex(Segment) ? SegmentRollConfigs[Segment] : FRollConfig());
+			for (int i = 0; i < SamplesPerSegment; i++) Alphas[i] = float(i) / float(SamplesPerSegment);
+			Easing.EvalArray(Alphas);
+			const float StartRoll = PointRolls[Segment];
+			const float DeltaRoll = PointRolls[Segment + 1] - StartRoll;
+			for (int i = 0; i < SamplesPerSegment; i++) Rolls[Segment * SamplesPerSegment + i] = StartRoll + DeltaRoll * Alphas[i];
+		}
+		Rolls[NumSamples - 1] = PointRolls[NumSegments];
+	}
+
+	BakedFrames.SetNum(NumSamples, NumSegments, SamplesPerSegment);
+	for (int Segment = 0; Segment < NumSegments; Segment++) BakedFrames.ChunkOrigins[Segment] = EvalPosition(float(Segment));
+	const float KeyStep = 1.f / float(SamplesPerSegment);
+	ParallelFor(NumSamples, [&](int32 Index)
+	{
+		const FVector& Forward = Tangents[Index];
+		const FVector Up = Rolls[Index] != 0.f ? FQuat(Forward, Rolls[Index]).RotateVector(Ups[Index]) : Ups[Index];
+		BakedFrames.SetSample(Index, EvalPosition(Index * KeyStep), FQuat(FMatrix(Forward, FVector::CrossProduct(Up, Forward), Up, FVector::ZeroVector)));
+	}, NumSamples < SGParallelBatchThreshold ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	if (bCompressBakedFrames)
+	{
+		TArray<FVector> Scales;
+		Scales.SetNumUninitialized(NumSamples);
+		for (int i = 0; i < NumSamples; i++) Scales[i] = EvalScale(i * KeyStep);
+		CompressedFrames.Encode(BakedFrames, Scales);
+		BakedFrames.Reset();
+	}
+
+	BakedFrameRevision = SplineRevision;
+	BakedFrameInputKey = ComputeFrameInputKey();
+}
+
+void USGSplineComponent::BuildReferenceFrames(int SamplesPerSegment, TArray<FVector>& OutTangents, TArray<FVector>& OutUps) const
+{
+	const int NumSamples = GetNumberOfSplineSegments() * SamplesPerSegment + 1;
+	const float KeyStep = 1.f / float(SamplesPerSegment);
+	const EParallelForFlags SampleFlags = NumSamples < SGParallelBatchThreshold ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None;
+	TArray<FVector> Positions;
+	Positions.SetNumUninitialized(NumSamples);
+	OutTangents.SetNumUninitialized(NumSamples);
+	OutUps.SetNumUninitialized(NumSamples);
+	ParallelFor(NumSamples, [&](int32 Index)
+	{
+		Positions[Index] = EvalPosition(Index * KeyStep);
+		OutTangents[Index] = EvalPositionDerivative(Index * KeyStep).GetSafeNormal();
+	}, SampleFlags);
+	for (int i = 0; i < NumSamples; i++)
+	{
+		if (OutTangents[i].IsNearlyZero()) OutTangents[i] = i > 0 ? OutTangents[i - 1] : FVector::ForwardVector;
+	}
+
+	// Rotation-minimising frame by double reflection (Wang et al. 2008): carries Up from sample i to i + 1.
+	auto DoubleReflect = [&Positions, &OutTangents](int i, const FVector& Up)
+	{
+		const FVector V1 = Positions[i + 1] - Positions[i];
+		const double C1 = FVector::DotProduct(V1, V1);
+		FVector ReflectedUp = Up;
+		FVector ReflectedTangent = OutTangents[i];
+		if (C1 > UE_SMALL_NUMBER)
+		{
+			ReflectedUp -= (2.0 / C1) * FVector::DotProduct(V1, ReflectedUp) * V1;
+			ReflectedTangent -= (2.0 / C1) * FVector::DotProduct(V1, ReflectedTangent) * V1;
+		}
+		const FVector V2 = OutTangents[i + 1] - ReflectedTangent;
+		const double C2 = FVector::DotProduct(V2, V2);
+		if (C2 > UE_SMALL_NUMBER) ReflectedUp -= (2.0 / C2) * FVector::DotProduct(V2, ReflectedUp) * V2;
+		return SGOrthogonalUp(ReflectedUp, OutTangents[i + 1]);
+	};
+
+	// Each chunk propagates from a provisional start up vector in parallel. The first chunk's start, world up projected off the tangent, is the real one,
+	// so frames don't depend on control point rotations. A chunk's end lands on the next chunk's start sample, so it goes to ChunkEndUps instead.
+	const int ChunkSize = 1024;
+	const int NumChunks = FMath::Max(FMath::DivideAndRoundUp(NumSamples - 1, ChunkSize), 1);
+	TArray<FVector> ChunkEndUps;
+	ChunkEndUps.SetNumUninitialized(NumChunks);
+	ParallelFor(NumChunks, [&](int32 Chunk)
+	{
+		const int First = Chunk * ChunkSize;
+		const int Last = FMath::Min(First + ChunkSize, NumSamples - 1);
+		OutUps[First] = SGOrthogonalUp(FVector::UpVector, OutTangents[First]);
+		for (int i = First; i < Last - 1; i++) OutUps[i + 1] = DoubleReflect(i, OutUps[i]);
+		if (Last > First)
+		{
+			const FVector EndUp = DoubleReflect(Last - 1, OutUps[Last - 1]);
+			if (Chunk == NumChunks - 1) OutUps[Last] = EndUp;
+			else ChunkEndUps[Chunk] = EndUp;
+		}
+	}, NumChunks < 2 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	// Prefix fix-up. Every step is a rotation taking one tangent to the next, so a chunk's true frames are its provisional ones rolled by a single angle about the tangent.
+	if (NumChunks > 1)
+	{
+		TArray<float> ChunkRolls;
+		ChunkRolls.SetNumZeroed(NumChunks);
+		for (int Chunk = 1; Chunk < NumChunks; Chunk++)
+		{
+			const int First = Chunk * ChunkSize;
+			const FVector PreviousEnd = FQuat(OutTangents[First], ChunkRolls[Chunk - 1]).RotateVector(ChunkEndUps[Chunk - 1]);
+			ChunkRolls[Chunk] = SGSignedAngleAround(OutUps[First], PreviousEnd, OutTangents[First]);
+		}
+		ParallelFor(NumSamples, [&](int32 Index)
+		{
+			const float Roll = ChunkRolls[FMath::Min(Index / ChunkSize, NumChunks - 1)];
+			if (Roll != 0.f) OutUps[Index] = FQuat(OutTangents[Index], Roll).RotateVector(OutUps[Index]);
+		}, SampleFlags);
+	}
+
+	// A closed loop generally comes back rotated relative to where it started. Unwind that evenly so the last frame matches the first.
+	if (IsClosedLoop() && NumSamples > 1)
+	{
+		const float Holonomy = SGSignedAngleAround(OutUps[NumSamples - 1], OutUps[0], OutTangents[NumSamples - 1]);
+		const float HolonomyPerSample = Holonomy / float(NumSamples - 1);
+		ParallelFor(NumSamples, [&](int32 Index)
+		{
+			OutUps[Index] = FQuat(OutTangents[Index], HolonomyPerSample * Index).RotateVector(OutUps[Index]);
+		}, NumSamples < SGParallelBatchThreshold ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+	}
+}
+
+void USGSplineComponent::ComputeAuthoredPointRolls(int SamplesPerSegment, const TArray<FVector>& Tangents, const TArray<FVector>& Ups, TArray<float>& OutPointRolls) const
+{
+	const int NumSegments = GetNumberOfSplineSegments();
+	const int NumPoints = SplineCurves.Rotation.Points.Num();
+	const bool bUseUpVectorCurve = SplineCurveUpVector.Points.Num() == NumPoints;
+	OutPointRolls.SetNumUninitialized(NumSegments + 1);
+	for (int Point = 0; Point <= NumSegments; Point++)
+	{
+		const int Sample = Point * SamplesPerSegment;
+		const int WrappedPoint = Point % NumPoints;
+		const FVector AuthoredUp = bUseUpVectorCurve ? SplineCurveUpVector.Points[WrappedPoint].OutVal : SplineCurves.Rotation.Points[WrappedPoint].OutVal.RotateVector(FVector::UpVector);
+		float Roll = SGSignedAngleAround(Ups[Sample], AuthoredUp, Tangents[Sample]);
+		if (Point > 0) Roll = OutPointRolls[Point - 1] + FMath::UnwindRadians(Roll - OutPointRolls[Point - 1]);
+		OutPointRolls[Point] = Roll;
+	}
+}
+
+void USGSplineComponent::ResampleRollChannel()
+{
+	// SplineShiftPoints keeps the channel in step when it inserts or removes points. Points added or removed any other way leave no record of where,
+	// so stretch the authored channel over the new keys by its position along the spline instead of reseeding it, which would lose every authored roll.
+	const int NumPoints = SplineCurves.Rotation.Points.Num();
+	const int NumSegments = GetNumberOfSplineSegments();
+	const FInterpCurveFloat OldRoll = SplineCurveRoll;
+	const float OldStartKey = OldRoll.Points[0].InVal;
+	const float OldEndKey = OldRoll.Points.Last().InVal + (OldRoll.bIsLooped ? OldRoll.LoopKeyOffset : 0.f);
+	UE_LOG(LogTemp, Display, TEXT("SplineCurveRoll has %d points for %d spline points. Resampling it onto the new points."), OldRoll.Points.Num(), NumPoints);
+
+	SplineCurveRoll.Points.SetNum(NumPoints);
+	for (int i = 0; i < NumPoints; i++)
+	{
+		const float Key = SplineCurves.Rotation.Points[i].InVal;
+		const float OldKey = NumSegments > 0 ? OldStartKey + (OldEndKey - OldStartKey) * (Key / float(NumSegments)) : OldStartKey;
+		SplineCurveRoll.Points[i] = FInterpCurvePoint<float>(Key, OldRoll.Eval(OldKey, 0.f), 0.f, 0.f, CIM_CurveAuto);
+	}
+	SplineCurveRoll.bIsLooped = IsClosedLoop();
+	if (IsClosedLoop()) SplineCurveRoll.SetLoopKey(SplineCurveRoll.Points.Last().InVal + 1.f);
+	else SplineCurveRoll.ClearLoopKey();
+	SplineCurveRoll.AutoSetTangents(0.0f, true);
+}
+
+void USGSplineComponent::ConvertUpVectorCurveToRollChannel(bool bUseRollChannel)
+{
+	const int NumSegments = GetNumberOfSplineSegments();
+	const int NumPoints = SplineCurves.Rotation.Points.Num();
+	SplineCurveRoll.Points.Reset();
+	RollChannelLoopTwist = 0.f;
+	MarkDerivedDataInputsChanged();
+	if (bUseRollChannel) UpVectorMode = ESGUpVectorMode::RollChannel;
+	if (NumSegments < 1 || NumPoints < 1)
+	{
+		UpdateFrameTable();
+		return;
+	}
+
+	const int SamplesPerSegment = FMath::Max(FramesPerSegment, 1);
+	TArray<FVector> Tangents;
+	TArray<FVector> Ups;
+	BuildReferenceFrames(SamplesPerSegment, Tangents, Ups);
+	TArray<float> PointRolls;
+	ComputeAuthoredPointRolls(SamplesPerSegment, Tangents, Ups, PointRolls);
+
+	// Whatever whole turns a loop accumulates go into RollChannelLoopTwist, leaving a channel whose last point leads smoothly into its first.
+	float LoopTwist = 0.f;
+	if (IsClosedLoop())
+	{
+		LoopTwist = PointRolls[NumSegments] - PointRolls[0];
+		RollChannelLoopTwist = FMath::RadiansToDegrees(LoopTwist);
+	}
+
+	SplineCurveRoll.Points.SetNum(NumPoints);
+	for (int i = 0; i < NumPoints; i++)
+	{
+		const float Key = SplineCurves.Rotation.Points[i].InVal;
+		const float Roll = PointRolls[i] - LoopTwist * (Key / float(NumSegments));
+		SplineCurveRoll.Points[i] = FInterpCurvePoint<float>(Key, FMath::RadiansToDegrees(Roll), 0.f, 0.f, CIM_CurveAuto);
+	}
+	SplineCurveRoll.bIsLooped = IsClosedLoop();
+	if (IsClosedLoop()) SplineCurveRoll.SetLoopKey(SplineCurveRoll.Points.Last().InVal + 1.f);
+	else SplineCurveRoll.ClearLoopKey();
+	SplineCurveRoll.AutoSetTangents(0.0f, true);
+
+	UpdateFrameTable();
+}
+
+bool USGSplineComponent::SampleBakedFrame(float InKey, FQuat& OutQuat) const
+{
+	if (!HasBakedFrames()) return false;
+	if (CompressedFrames.Num() > 1) OutQuat = CompressedFrames.SampleRotation(InKey * CompressedFrames.SamplesPerChunk);
+	else OutQuat = FQuat(BakedFrames.SampleRotation(InKey * BakedFrames.SamplesPerChunk));
+	return true;
+}
+
+FSGFrameCompressionReport USGSplineComponent::GetFrameCompressionReport()
+{
+	FSGFrameCompressionReport Report;
+	if (UpVectorMode == ESGUpVectorMode::HermiteCurve) return Report;
+
+	// Measure against a float table, baking one if only the compressed table is resident.
+	const bool bWasCompressed = bCompressBakedFrames;
+	bCompressBakedFrames = false;
+	if (BakedFrames.Num() < 2 || BakedFrameRevision != SplineRevision || BakedFrameInputKey != ComputeFrameInputKey()) UpdateFrameTable();
+	bCompressBakedFrames = bWasCompressed;
+	const int NumSamples = BakedFrames.Num();
+	if (NumSamples < 2) return Report;
+
+	const float KeyStep = 1.f / float(BakedFrames.SamplesPerChunk);
+	TArray<FVector> Scales;
+	Scales.SetNumUninitialized(NumSamples);
+	for (int i = 0; i < NumSamples; i++) Scales[i] = EvalScale(i * KeyStep);
+	FSGCompressedFrameTable Compressed;
+	Compressed.Encode(BakedFrames, Scales);
+	TArray<FVector3f> Forwards;
+	TArray<FVector3f> Ups;
+	Compressed.DecodeAxes(0, NumSamples, Forwards, Ups);
+
+	float MaxOffset = 0.f;
+	float MaxAngle = 0.f;
+	for (int i = 0; i < NumSamples; i++)
+	{
+		const FVector Reference = EvalPosition(i * KeyStep);
+		MaxOffset = FMath::Max(MaxOffset, FVector3f(BakedFrames.PositionX[i], BakedFrames.PositionY[i], BakedFrames.PositionZ[i]).GetAbsMax());
+		Report.FloatMaxPositionError = FMath::Max(Report.FloatMaxPositionError, float((BakedFrames.GetPosition(i) - Reference).Size()));
+		Report.CompressedMaxPositionError = FMath::Max(Report.CompressedMaxPositionError, float((Compressed.GetPosition(i) - Reference).Size()));
+
+		const FQuat Rotation = BakedFrames.GetRotation(i).GetNormalized();
+		MaxAngle = FMath::Max(MaxAngle, FMath::Acos(FMath::Clamp(float(FVector::DotProduct(FVector(Forwards[i]), Rotation.GetAxisX())), -1.f, 1.f)));
+		MaxAngle = FMath::Max(MaxAngle, FMath::Acos(FMath::Clamp(float(FVector::DotProduct(FVector(Ups[i]), Rotation.GetAxisZ())), -1.f, 1.f)));
+		Report.CompressedMaxScaleError = FMath::Max(Report.CompressedMaxScaleError, float((Compressed.GetScale(i) - Scales[i]).GetAbsMax()));
+	}
+
+	// Spline units are centimetres.
+	const double Metres = GetSplineLength() / 100.0;
+	Report.NumSamples = NumSamples;
+	Report.TrackLengthMetres = float(Metres);
+	Report.FloatBytesPerMetre = Metres > 0.0 ? float(BakedFrames.GetAllocatedSize() / Metres) : 0.f;
+	Report.CompressedBytesPerMetre = Metres > 0.0 ? float(Compressed.GetAllocatedSize() / Metres) : 0.f;
+	// Half an ulp on every axis of the largest chunk relative offset.
+	Report.FloatPositionErrorBound = 0.5f * FLT_EPSILON * FMath::Sqrt(3.f) * MaxOffset;
+	Report.CompressedPositionErrorBound = Compressed.GetPositionErrorBound();
+	Report.CompressedMaxAngleError = FMath::RadiansToDegrees(MaxAngle);
+
+	if (bWasCompressed)
+	{
+		CompressedFrames = MoveTemp(Compressed);
+		BakedFrames.Reset();
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Frame tables over %f m: float32 %f bytes/m, max position error %f; compressed %f bytes/m, max position error %f (bound %f), max angle error %f deg"),
+		Report.TrackLengthMetres, Report.FloatBytesPerMetre, Report.FloatMaxPositionError, Report.CompressedBytesPerMetre, Report.CompressedMaxPositionError, Report.CompressedPositionErrorBound, Report.CompressedMaxAngleError);
+	return Report;
+}
+
+void FSGFrameTable::Reset()
+{
+	SamplesPerChunk = 0;
+	ChunkOrigins.Reset();
+	PositionX.Reset();
+	PositionY.Reset();
+	PositionZ.Reset();
+	RotationX.Reset();
+	RotationY.Reset();
+	RotationZ.Reset();
+	RotationW.Reset();
+}
+
+void FSGFrameTable::SetNum(int NumSamples, int NumChunks, int InSamplesPerChunk)
+{
+	SamplesPerChunk = InSamplesPerChunk;
+	ChunkOrigins.SetNumZeroed(NumChunks);
+	PositionX.SetNumUninitialized(NumSamples);
+	PositionY.SetNumUninitialized(NumSamples);
+	PositionZ.SetNumUninitialized(NumSamples);
+	RotationX.SetNumUninitialized(NumSamples);
+	RotationY.SetNumUninitialized(NumSamples);
+	RotationZ.SetNumUninitialized(NumSamples);
+	RotationW.SetNumUninitialized(NumSamples);
+}
+
+void FSGFrameTable::SetSample(int Sample, const FVector& Position, const FQuat& Rotation)
+{
+	const FVector Offset = Position - ChunkOrigins[GetChunk(Sample)];
+	PositionX[Sample] = float(Offset.X);
+	PositionY[Sample] = float(Offset.Y);
+	PositionZ[Sample] = float(Offset.Z);
+	RotationX[Sample] = float(Rotation.X);
+	RotationY[Sample] = float(Rotation.Y);
+	RotationZ[Sample] = float(Rotation.Z);
+	RotationW[Sample] = float(Rotation.W);
+}
+
+FQuat4f FSGFrameTable::SampleRotation(float Sample) const
+{
+	Sample = FMath::Clamp(Sample, 0.f, float(Num() - 1));
+	const int Index = FMath::Min(FMath::FloorToInt(Sample), Num() - 2);
+	const FQuat4f A(RotationX[Index], RotationY[Index], RotationZ[Index], RotationW[Index]);
+	const FQuat4f B(RotationX[Index + 1], RotationY[Index + 1], RotationZ[Index + 1], RotationW[Index + 1]);
+	return FQuat4f::FastLerp(A, B, Sample - Index).GetNormalized();
+}
+
+void FSGFrameTable::SampleTransforms(TArrayView<const float> Samples, const FTransform& ToOutput, TArrayView<FTransform> OutTransforms) const
+{
+	const int LastSample = Num() - 1;
+	for (int i = 0; i < Samples.Num(); i++)
+	{
+		const float Sample = FMath::Clamp(Samples[i], 0.f, float(LastSample));
+		const int Index = FMath::Min(FMath::FloorToInt(Sample), LastSample - 1);
+		const float Alpha = Sample - Index;
+		const int Chunk = GetChunk(Index);
+		const int NextChunk = GetChunk(Index + 1);
+
+		// The next sample may start a new chunk; rebase it onto this one. Neighbouring origins are close, so the difference fits a float.
+		const FVector3f NextRebase = NextChunk != Chunk ? FVector3f(ChunkOrigins[NextChunk] - ChunkOrigins[Chunk]) : FVector3f::ZeroVector;
+		const FVector3f Offset(
+			FMath::Lerp(PositionX[Index], PositionX[Index + 1] + NextRebase.X, Alpha),
+			FMath::Lerp(PositionY[Index], PositionY[Index + 1] + NextRebase.Y, Alpha),
+			FMath::Lerp(PositionZ[Index], PositionZ[Index + 1] + NextRebase.Z, Alpha));
+
+		OutTransforms[i] = FTransform(FQuat(SampleRotation(Sample)), ChunkOrigins[Chunk] + FVector(Offset)) * ToOutput;
+	}
+}
+
+void FSGFrameTable::Serialize(FArchive& Ar)
+{
+	Ar << SamplesPerChunk << ChunkOrigins;
+	Ar << PositionX << PositionY << PositionZ;
+	Ar << RotationX << RotationY << RotationZ << RotationW;
+}
+
+SIZE_T FSGFrameTable::GetAllocatedSize() const
+{
+	return ChunkOrigins.GetAllocatedSize()
+		+ PositionX.GetAllocatedSize() + PositionY.GetAllocatedSize() + PositionZ.GetAllocatedSize()
+		+ RotationX.GetAllocatedSize() + RotationY.GetAllocatedSize() + RotationZ.GetAllocatedSize() + RotationW.GetAllocatedSize();
 }
 
 void USGSplineComponent::UpdateUpVectorSpline(bool bUpdateSplineFirst)
 {
 	if (bUpdateSplineFirst) UpdateSpline();
+	if (!UsesUpVectorCurve())
+	{
+		// Frames in these modes come from the reference frame and SplineCurveRoll alone. The curve is built again once the mode switches back.
+		SplineCurveUpVector.Points.Empty();
+		SplineCurveUpVector.ClearLoopKey();
+		if (CurveCoefficientRevision != SplineRevision) UpdateCurveCoefficients();
+		UpdateUpVectorCoefficients();
+		return;
+	}
 	SplineCurveUpVector.Points.SetNum(SplineCurves.Rotation.Points.Num());
 	for (int i = 0; i < SplineCurves.Rotation.Points.Num(); i++)
 	{
@@ -70,22 +1145,43 @@ void USGSplineComponent::UpdateUpVectorSpline(bool bUpdateSplineFirst)
 
 	// Automatically set the tangents on any CurveAuto keys
 	SplineCurveUpVector.AutoSetTangents(0.0f, true);
+	if (CurveCoefficientRevision != SplineRevision) UpdateCurveCoefficients();
+	UpdateUpVectorCoefficients();
 }
 
 void USGSplineComponent::UpdateLocalOffsetPositionSpline(bool bUpdateSplineFirst)
 {
 	//if (!bEnableSmoothTangentsForLocalOffset) return;
 	if (bUpdateSplineFirst) UpdateSpline();
-	int SegmentCount = FMath::RoundToInt(GetSplineLength() / TargetMeshLength);
-	LocalOffsetSplineSegmentLength = GetSplineLength() / float(SegmentCount);
+	if (!bEnableLocalOffset)
+	{
+		SplineCurveLocalOffsetPosition.Points.Reset();
+		return;
+	}
+
+	// Claim the build like UpdateSGSplines does, so the queries below read the tables as they are instead of starting a full build that comes back here.
+	FScopeLock Lock(&DerivedDataLock);
+	const uint32 OuterBuildThreadId = DerivedDataBuildThreadId.exchange(FPlatformTLS::GetCurrentThreadId());
+
+	// The offset points are placed by the cursor along the corrected frames, so the arc length tables and the frames have to match the spline first,
+	// in UpdateSGSplines' order. Inside UpdateSGSplines they already do.
+	if (UpVectorCoefficientRevision != SplineRevision) UpdateUpVectorSpline(false);
+	const bool bArcLengthTablesStale = (ArcLengthMode == ESGArcLengthMode::Exact && !HasExactArcLengths()) || (ArcLengthMode == ESGArcLengthMode::AdaptiveTable && !HasAdaptiveReparamTable());
+	if (bArcLengthTablesStale) UpdateArcLengthTable();
+	if (UpVectorMode != ESGUpVectorMode::HermiteCurve && !HasBakedFrames()) UpdateFrameTable();
+
+	const float SplineLength = GetCorrectSplineLength();
+	int SegmentCount = TargetMeshLength > 0.f ? FMath::Max(FMath::RoundToInt(SplineLength / TargetMeshLength), 1) : 1;
+	LocalOffsetSplineSegmentLength = SplineLength / float(SegmentCount);
 	SplineCurveLocalOffsetPosition.Points.SetNum(SegmentCount);
 
+	FSGSplineCursor Cursor(this);
 	for (int i = 0; i < SegmentCount; i++)
 	{
 		float CurrentDist = LocalOffsetSplineSegmentLength * i;
 		SplineCurveLocalOffsetPosition.Points[i] = FInterpCurvePoint(
 			float(i),
-			GetLocalOffsetLocationAtDistanceAlongSpline(CurrentDist, LocalOffset, ESplineCoordinateSpace::Local),
+			GetLocalOffsetLocationAtSplineInputKey(Cursor.GetInputKeyAtDistance(CurrentDist), LocalOffset, ESplineCoordinateSpace::Local),
 			FVector::ZeroVector,
 			FVector::ZeroVector,
 			CIM_CurveAuto
@@ -105,7 +1201,8 @@ void USGSplineComponent::UpdateLocalOffsetPositionSpline(bool bUpdateSplineFirst
 
 	SplineCurveLocalOffsetPosition.AutoSetTangents(0.0f, true);
 
-	OffsetSplineEstimatedLength = GetSplineLength() + TargetMeshLength;//(LocalOffset.Length() * 4.f);
+	OffsetSplineEstimatedLength = SplineLength + TargetMeshLength;//(LocalOffset.Length() * 4.f);
+	DerivedDataBuildThreadId.store(OuterBuildThreadId);
 }
 
 void USGSplineComponent::ApplyLocalOffset(FVector2D Offset)
@@ -121,6 +1218,7 @@ void USGSplineComponent::ApplyLocalOffset(FVector2D Offset)
 
 float USGSplineComponent::GetInputKeyAtLocationFromOffsetSpline(const FVector& InLocation, ESplineCoordinateSpace::Type CoordinateSpace) const
 {
+	EnsureDerivedData();
 	const FVector LocalLocation = (CoordinateSpace == ESplineCoordinateSpace::World) ? GetComponentTransform().InverseTransformPosition(InLocation) : InLocation;
 	float Dummy;
 	return SplineCurveLocalOffsetPosition.FindNearest(LocalLocation, Dummy);
@@ -128,14 +1226,15 @@ float USGSplineComponent::GetInputKeyAtLocationFromOffsetSpline(const FVector& I
 
 FQuat USGSplineComponent::GetCorrectQuaternionAtSplineInputKey(float InKey, ESplineCoordinateSpace::Type CoordinateSpace) const
 {
+	EnsureDerivedData();
 	//return GetQuaternionAtSplineInputKey(InKey, CoordinateSpace);
-	FQuat Quat = SplineCurves.Rotation.Eval(InKey, FQuat::Identity);
-	Quat.Normalize();
-
-	const FVector Direction = SplineCurves.Position.EvalDerivative(InKey, FVector::ZeroVector).GetSafeNormal();
-	const FVector UpVector = SplineCurveUpVector.Eval(InKey, FVector::UpVector).GetSafeNormal();
-
-	FQuat Rot = (FRotationMatrix::MakeFromXZ(Direction, UpVector)).ToQuat();
+	FQuat Rot;
+	if (!SampleBakedFrame(InKey, Rot))
+	{
+		const FVector Direction = EvalPositionDerivative(InKey).GetSafeNormal();
+		const FVector UpVector = EvalUpVector(InKey).GetSafeNormal();
+		Rot = (FRotationMatrix::MakeFromXZ(Direction, UpVector)).ToQuat();
+	}
 
 	if (CoordinateSpace == ESplineCoordinateSpace::World)
 	{
@@ -147,13 +1246,13 @@ FQuat USGSplineComponent::GetCorrectQuaternionAtSplineInputKey(float InKey, ESpl
 
 FQuat USGSplineComponent::GetCorrectQuaternionAtDistanceAlongSpline(float Distance, ESplineCoordinateSpace::Type CoordinateSpace) const
 {
-	const float Param = SplineCurves.ReparamTable.Eval(Distance, 0.0f);
+	const float Param = GetCorrectInputKeyAtDistanceAlongSpline(Distance);
 	return GetCorrectQuaternionAtSplineInputKey(Param, CoordinateSpace);
 }
 
 FRotator USGSplineComponent::GetCorrectRotationAtDistanceAlongSpline(float Distance, ESplineCoordinateSpace::Type CoordinateSpace) const
 {
-	const float Param = SplineCurves.ReparamTable.Eval(Distance, 0.0f);
+	const float Param = GetCorrectInputKeyAtDistanceAlongSpline(Distance);
 	return GetCorrectRotationAtSplineInputKey(Param, CoordinateSpace);
 }
 
@@ -189,15 +1288,16 @@ FVector USGSplineComponent::GetCorrectUpVectorAtSplineInputKey(float InKey, ESpl
 
 FVector USGSplineComponent::GetCorrectUpVectorAtDistanceAlongSpline(float Distance, ESplineCoordinateSpace::Type CoordinateSpace) const
 {
-	const float Param = SplineCurves.ReparamTable.Eval(Distance, 0.0f);
+	const float Param = GetCorrectInputKeyAtDistanceAlongSpline(Distance);
 	return GetCorrectUpVectorAtSplineInputKey(Param, CoordinateSpace);
 }
 
 FTransform USGSplineComponent::GetCorrectTransformAtSplineInputKey(float InKey, ESplineCoordinateSpace::Type CoordinateSpace, bool bUseScale) const
 {
-	const FVector Location(GetLocationAtSplineInputKey(InKey, ESplineCoordinateSpace::Local));
+	EnsureDerivedData();
+	const FVector Location(EvalPosition(InKey));
 	const FQuat Rotation(GetCorrectQuaternionAtSplineInputKey(InKey, ESplineCoordinateSpace::Local));
-	const FVector Scale = bUseScale ? GetScaleAtSplineInputKey(InKey) : FVector(1.0f);
+	const FVector Scale = bUseScale ? EvalScale(InKey) : FVector(1.0f);
 
 	FTransform Transform(Rotation, Location, Scale);
 
@@ -209,12 +1309,238 @@ FTransform USGSplineComponent::GetCorrectTransformAtSplineInputKey(float InKey,
 	return Transform;
 }
 
+void USGSplineComponent::GetCorrectTransformsAtSplineInputKeys(const TArray<float>& InKeys, ESplineCoordinateSpace::Type CoordinateSpace, TArray<FTransform>& OutTransforms) const
+{
+	EnsureDerivedData();
+	OutTransforms.SetNumUninitialized(InKeys.Num());
+	if (!HasBakedFrames())
+	{
+		for (int i = 0; i < InKeys.Num(); i++) OutTransforms[i] = GetCorrectTransformAtSplineInputKey(InKeys[i], CoordinateSpace, false);
+		return;
+	}
+
+	const bool bCompressed = CompressedFrames.Num() > 1;
+	const int SamplesPerSegment = bCompressed ? CompressedFrames.SamplesPerChunk : BakedFrames.SamplesPerChunk;
+	TArray<float> Samples;
+	Samples.SetNumUninitialized(InKeys.Num());
+	for (int i = 0; i < InKeys.Num(); i++) Samples[i] = InKeys[i] * SamplesPerSegment;
+	const FTransform ToOutput = CoordinateSpace == ESplineCoordinateSpace::World ? GetComponentTransform() : FTransform::Identity;
+
+	// Batches go out in parallel slices, each converted with the same output transform.
+	const int NumSlices = InKeys.Num() < SGParallelBatchThreshold ? 1 : FMath::DivideAndRoundUp(InKeys.Num(), SGParallelBatchThreshold);
+	ParallelFor(NumSlices, [&](int32 Slice)
+	{
+		const int First = Slice * SGParallelBatchThreshold;
+		const int Count = NumSlices == 1 ? InKeys.Num() : FMath::Min(SGParallelBatchThreshold, InKeys.Num() - First);
+		const TArrayView<const float> SliceSamples(Samples.GetData() + First, Count);
+		const TArrayView<FTransform> SliceTransforms(OutTransforms.GetData() + First, Count);
+		if (bCompressed) CompressedFrames.SampleTransforms(SliceSamples, ToOutput, SliceTransforms);
+		else BakedFrames.SampleTransforms(SliceSamples, ToOutput, SliceTransforms);
+	}, NumSlices == 1 ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
 FTransform USGSplineComponent::GetCorrectTransformAtDistanceAlongSpline(float Distance, ESplineCoordinateSpace::Type CoordinateSpace, bool bUseScale) const
 {
-	const float Param = SplineCurves.ReparamTable.Eval(Distance, 0.0f);
+	const float Param = GetCorrectInputKeyAtDistanceAlongSpline(Distance);
 	return GetCorrectTransformAtSplineInputKey(Param, CoordinateSpace, bUseScale);
 }
 
+void USGSplineComponent::GetCorrectFrameAtSplineInputKey(float InKey, FVector& OutLocation, FVector& OutForward, FVector& OutRight, FVector& OutUp) const
+{
+	EnsureDerivedData();
+	OutLocation = EvalPosition(InKey);
+	FQuat BakedFrame;
+	if (SampleBakedFrame(InKey, BakedFrame))
+	{
+		OutForward = BakedFrame.GetAxisX();
+		OutRight = BakedFrame.GetAxisY();
+		OutUp = BakedFrame.GetAxisZ();
+		return;
+	}
+	OutForward = EvalPositionDerivative(InKey).GetSafeNormal();
+	const FVector UpVector = EvalUpVector(InKey).GetSafeNormal();
+
+	// Orthonormalize the same way FRotationMatrix::MakeFromXZ does, falling back to it for degenerate cases.
+	OutRight = FVector::CrossProduct(UpVector, OutForward).GetSafeNormal();
+	if (OutRight.IsNearlyZero())
+	{
+		const FMatrix Matrix = FRotationMatrix::MakeFromXZ(OutForward, UpVector);
+		OutForward = Matrix.GetUnitAxis(EAxis::X);
+		OutRight = Matrix.GetUnitAxis(EAxis::Y);
+		OutUp = Matrix.GetUnitAxis(EAxis::Z);
+		return;
+	}
+	OutUp = FVector::CrossProduct(OutForward, OutRight);
+}
+
+float USGSplineComponent::FindInputKeyClosestToLocalLocation(const FVector& LocalLocation, float HintKey, float MaxHintDistance) const
+{
+	EnsureDerivedData();
+	const FInterpCurveVector& Position = SplineCurves.Position;
+	const int32 NumPoints = Position.Points.Num();
+	float Dummy;
+	if (HintKey < 0.f || NumPoints < 2) return Position.FindNearest(LocalLocation, Dummy);
+
+	// Only check the hinted segment and its neighbours.
+	const int32 NumSegments = Position.bIsLooped ? NumPoints : NumPoints - 1;
+	const int32 HintSegment = FMath::Clamp(FMath::FloorToInt(HintKey), 0, NumSegments - 1);
+	float BestKey = HintKey;
+	float BestDistanceSq = TNumericLimits<float>::Max();
+	int32 BestOffset = 0;
+	int32 BestSegment = HintSegment;
+	for (int32 Offset = -1; Offset <= 1; Offset++)
+	{
+		int32 Segment = HintSegment + Offset;
+		if (Position.bIsLooped) Segment = (Segment + NumSegments) % NumSegments;
+		else if (Segment < 0 || Segment >= NumSegments) continue;
+
+		float DistanceSq;
+		const float Key = Position.FindNearestOnSegment(LocalLocation, Segment, DistanceSq);
+		if (DistanceSq < BestDistanceSq)
+		{
+			BestDistanceSq = DistanceSq;
+			BestKey = Key;
+			BestOffset = Offset;
+			BestSegment = Segment;
+		}
+	}
+
+	// A nearest point on the edge of the window may really be further along, as after a hitch or a teleport, and so may one too far from the track.
+	// Search the whole spline then, so a stale hint can't keep the result on the wrong segment.
+	const bool bWindowCoversSpline = Position.bIsLooped && NumSegments <= 3;
+	const bool bAtWindowStart = BestOffset == -1 && BestKey <= BestSegment + UE_KINDA_SMALL_NUMBER && (Position.bIsLooped || BestSegment > 0);
+	const bool bAtWindowEnd = BestOffset == 1 && BestKey >= BestSegment + 1 - UE_KINDA_SMALL_NUMBER && (Position.bIsLooped || BestSegment < NumSegments - 1);
+	const bool bTooFar = MaxHintDistance >= 0.f && BestDistanceSq > FMath::Square(MaxHintDistance);
+	if (!bWindowCoversSpline && (bAtWindowStart || bAtWindowEnd || bTooFar)) return Position.FindNearest(LocalLocation, Dummy);
+	return BestKey;
+}
+
+FSGTrackSurfaceHit USGSplineComponent::QueryTrackSurface(const FVector& WorldLocation, FVector2D ProfileExtent, float HintKey) const
+{
+	const FTransform& ComponentTransform = GetComponentTransform();
+	FSGTrackSurfaceHit Hit;
+	// Past the profile the hinted segments are no longer trusted. The extent is in world units, so bring it into local space.
+	const float MaxHintDistance = ProfileExtent.Size() / FMath::Max(ComponentTransform.GetMinimumAxisScale(), UE_KINDA_SMALL_NUMBER);
+	Hit.InputKey = FindInputKeyClosestToLocalLocation(ComponentTransform.InverseTransformPosition(WorldLocation), HintKey, MaxHintDistance);
+
+	FVector Center, Forward, Right, Up;
+	GetCorrectFrameAtSplineInputKey(Hit.InputKey, Center, Forward, Right, Up);
+	Center = ComponentTransform.TransformPosition(Center);
+	Forward = ComponentTransform.TransformVectorNoScale(Forward);
+	Right = ComponentTransform.TransformVectorNoScale(Right);
+	Up = ComponentTransform.TransformVectorNoScale(Up);
+
+	Hit.LateralOffset = FVector::DotProduct(WorldLocation - Center, Right);
+	Hit.bOnSurface = FMath::Abs(Hit.LateralOffset) <= ProfileExtent.X;
+	Hit.Location = Center + (Right * FMath::Clamp(Hit.LateralOffset, -ProfileExtent.X, ProfileExtent.X)) + (Up * ProfileExtent.Y);
+	Hit.Normal = Up;
+	Hit.HeightAboveSurface = FVector::DotProduct(WorldLocation - Hit.Location, Up);
+	Hit.Frame = FTransform(FQuat(FMatrix(Forward, Right, Up, FVector::ZeroVector)), Center);
+	return Hit;
+}
+
+void USGSplineComponent::QueryTrackSurfaceBatch(const TArray<FVector>& WorldLocations, FVector2D ProfileExtent, TArray<float>& HintKeys, TArray<FSGTrackSurfaceHit>& OutHits) const
+{
+	EnsureDerivedData();
+	const int32 Num = WorldLocations.Num();
+	const bool bUseHints = HintKeys.Num() == Num;
+	OutHits.SetNum(Num);
+	ParallelFor(Num, [&](int32 Index)
+	{
+		OutHits[Index] = QueryTrackSurface(WorldLocations[Index], ProfileExtent, bUseHints ? HintKeys[Index] : -1.f);
+	}, Num < SGParallelBatchThreshold ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+
+	HintKeys.SetNum(Num);
+	for (int32 i = 0; i < Num; i++) HintKeys[i] = OutHits[i].InputKey;
+}
+
+FVector USGSplineComponent::GetTrackCoordinateAtLocation(const FVector& Location, ESplineCoordinateSpace::Type CoordinateSpace) const
+{
+	const FTransform& ComponentTransform = GetComponentTransform();
+	const bool bWorld = CoordinateSpace == ESplineCoordinateSpace::World;
+	const float Key = FindInputKeyClosestToLocalLocation(bWorld ? ComponentTransform.InverseTransformPosition(Location) : Location);
+
+	FVector Center, Forward, Right, Up;
+	GetCorrectFrameAtSplineInputKey(Key, Center, Forward, Right, Up);
+	if (bWorld)
+	{
+		Center = ComponentTransform.TransformPosition(Center);
+		Right = ComponentTransform.TransformVectorNoScale(Right);
+		Up = ComponentTransform.TransformVectorNoScale(Up);
+	}
+	const FVector Delta = Location - Center;
+	return FVector(GetCorrectDistanceAlongSplineAtSplineInputKey(Key), FVector::DotProduct(Delta, Right), FVector::DotProduct(Delta, Up));
+}
+
+FVector USGSplineComponent::GetLocationAtTrackCoordinate(const FVector& TrackCoordinate, ESplineCoordinateSpace::Type CoordinateSpace) const
+{
+	const float Param = GetCorrectInputKeyAtDistanceAlongSpline(TrackCoordinate.X);
+	FVector Center, Forward, Right, Up;
+	GetCorrectFrameAtSplineInputKey(Param, Center, Forward, Right, Up);
+	if (CoordinateSpace == ESplineCoordinateSpace::World)
+	{
+		const FTransform& ComponentTransform = GetComponentTransform();
+		Center = ComponentTransform.TransformPosition(Center);
+		Right = ComponentTransform.TransformVectorNoScale(Right);
+		Up = ComponentTransform.TransformVectorNoScale(Up);
+	}
+	return Center + (Right * TrackCoordinate.Y) + (Up * TrackCoordinate.Z);
+}
+
+void USGSplineComponent::GetTrackCoordinatesAtLocations(const TArray<FVector>& Locations, ESplineCoordinateSpace::Type CoordinateSpace, TArray<FVector>& OutTrackCoordinates) const
+{
+	EnsureDerivedData();
+	const int32 Num = Locations.Num();
+	OutTrackCoordinates.SetNumUninitialized(Num);
+	ParallelFor(Num, [&](int32 Index)
+	{
+		OutTrackCoordinates[Index] = GetTrackCoordinateAtLocation(Locations[Index], CoordinateSpace);
+	}, Num < SGParallelBatchThreshold ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+void USGSplineComponent::GetTrackCoordinatesAtLocationsSoA(const TArray<FVector>& Locations, ESplineCoordinateSpace::Type CoordinateSpace, TArray<float>& OutDistances, TArray<float>& OutLateralOffsets, TArray<float>& OutVerticalOffsets) const
+{
+	EnsureDerivedData();
+	const int32 Num = Locations.Num();
+	OutDistances.SetNumUninitialized(Num);
+	OutLateralOffsets.SetNumUninitialized(Num);
+	OutVerticalOffsets.SetNumUninitialized(Num);
+	ParallelFor(Num, [&](int32 Index)
+	{
+		const FVector TrackCoordinate = GetTrackCoordinateAtLocation(Locations[Index], CoordinateSpace);
+		OutDistances[Index] = TrackCoordinate.X;
+		OutLateralOffsets[Index] = TrackCoordinate.Y;
+		OutVerticalOffsets[Index] = TrackCoordinate.Z;
+	}, Num < SGParallelBatchThreshold ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+void USGSplineComponent::GetLocationsAtTrackCoordinates(const TArray<FVector>& TrackCoordinates, ESplineCoordinateSpace::Type CoordinateSpace, TArray<FVector>& OutLocations) const
+{
+	EnsureDerivedData();
+	const int32 Num = TrackCoordinates.Num();
+	OutLocations.SetNumUninitialized(Num);
+	ParallelFor(Num, [&](int32 Index)
+	{
+		OutLocations[Index] = GetLocationAtTrackCoordinate(TrackCoordinates[Index], CoordinateSpace);
+	}, Num < SGParallelBatchThreshold ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
+void USGSplineComponent::GetLocationsAtTrackCoordinatesSoA(const TArray<float>& Distances, const TArray<float>& LateralOffsets, const TArray<float>& VerticalOffsets, ESplineCoordinateSpace::Type CoordinateSpace, TArray<FVector>& OutLocations) const
+{
+	EnsureDerivedData();
+	if (LateralOffsets.Num() != Distances.Num() || VerticalOffsets.Num() != Distances.Num())
+	{
+		OutLocations.Empty();
+		return;
+	}
+	const int32 Num = Distances.Num();
+	OutLocations.SetNumUninitialized(Num);
+	ParallelFor(Num, [&](int32 Index)
+	{
+		OutLocations[Index] = GetLocationAtTrackCoordinate(FVector(Distances[Index], LateralOffsets[Index], VerticalOffsets[Index]), CoordinateSpace);
+	}, Num < SGParallelBatchThreshold ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None);
+}
+
 int USGSplineComponent::GetLastSplinePoint() const
 {
 	return GetNumberOfSplinePoints() - 1;
@@ -266,34 +1592,30 @@ int USGSplineComponent::WrapSplinePointToRange(int SplinePoint) const
 	return FMath::Wrap(SplinePoint, 0, GetLastSplinePoint());
 }
 
-int USGSplineComponent::GetSegmentLength(int SplinePoint) const
+float USGSplineComponent::GetSegmentLength(int SplinePoint) const
 {
 	//SplinePoint = WrapSplinePointToRange(SplinePoint);
 	//return SplineCurves.GetSegmentLength(SplinePoint, 1.f, IsClosedLoop(), GetComponentTransform().GetScale3D());
-	
-	float Start = GetDistanceAlongSplineAtSplinePoint(SplinePoint);
-	int NextSplinePoint = GetNextSplinePoint(SplinePoint);
-	float End = 0.f;
-	if (NextSplinePoint != 0) End = GetDistanceAlongSplineAtSplinePoint(NextSplinePoint);
-	else End = GetSplineLength();
-	return FMath::Abs(End - Start);
+	return GetSegmentLayout(SplinePoint).Length;
 }
 
 FVector USGSplineComponent::GetLocalOffsetLocationAtSplineInputKey(float InKey, FVector2D NewLocalOffset, ESplineCoordinateSpace::Type CoordinateSpace)
 {
-	FVector Location = GetLocationAtSplineInputKey(InKey, CoordinateSpace);
+	FVector Location = EvalPosition(InKey);
+	if (CoordinateSpace == ESplineCoordinateSpace::World) Location = GetComponentTransform().TransformPosition(Location);
 	FVector LocalizedOffset3D = (GetRightVectorAtSplineInputKey(InKey, CoordinateSpace) * LocalOffset.X) + (GetCorrectUpVectorAtSplineInputKey(InKey, CoordinateSpace) * LocalOffset.Y);
 	return Location + LocalizedOffset3D;
 }
 
 FVector USGSplineComponent::GetLocalOffsetLocationAtDistanceAlongSpline(float Distance, FVector2D NewLocalOffset, ESplineCoordinateSpace::Type CoordinateSpace)
 {
-	const float Param = SplineCurves.ReparamTable.Eval(Distance, 0.0f);
+	const float Param = GetCorrectInputKeyAtDistanceAlongSpline(Distance);
 	return GetLocalOffsetLocationAtSplineInputKey(Param, LocalOffset, CoordinateSpace);
 }
 
 FVector USGSplineComponent::GetLocalOffsetLocationAtSplineInputKeyFromOffsetSpline(float InKey, ESplineCoordinateSpace::Type CoordinateSpace)
 {
+	EnsureDerivedData();
 	FVector Location = SplineCurveLocalOffsetPosition.Eval(InKey, FVector::ZeroVector);
 	if (CoordinateSpace == ESplineCoordinateSpace::World)
 	{
@@ -304,6 +1626,7 @@ FVector USGSplineComponent::GetLocalOffsetLocationAtSplineInputKeyFromOffsetSpli
 
 FVector USGSplineComponent::GetLocalOffsetTangentAtSplineInputKeyFromOffsetSpline(float InKey, ESplineCoordinateSpace::Type CoordinateSpace)
 {
+	EnsureDerivedData();
 	FVector Tangent = SplineCurveLocalOffsetPosition.EvalDerivative(InKey, FVector::ZeroVector);
 	if (CoordinateSpace == ESplineCoordinateSpace::World)
 	{
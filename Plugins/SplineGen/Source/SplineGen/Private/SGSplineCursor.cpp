@@ -0,0 +1,132 @@
+#include "SGSplineCursor.h"
+#include "SGSplineComponent.h"
+
+// Linear steps tried from the last bracket before falling back to a binary search.
+static const int SGCursorMaxLinearSteps = 8;
+
+// Bracket in a sorted table of NumSamples distances such that GetDistance(Bracket) <= Target < GetDistance(Bracket + 1), clamped to [0, NumSamples - 2].
+template<typename GetDistanceT>
+static int SGAdvanceBracket(int Bracket, int NumSamples, double Target, GetDistanceT GetDistance)
+{
+	const int LastBracket = NumSamples - 2;
+	Bracket = FMath::Clamp(Bracket, 0, LastBracket);
+	for (int Step = 0; Step < SGCursorMaxLinearSteps; Step++)
+	{
+		if (Bracket > 0 && GetDistance(Bracket) > Target) Bracket--;
+		else if (Bracket < LastBracket && GetDistance(Bracket + 1) <= Target) Bracket++;
+		else return Bracket;
+	}
+
+	// Upper bound: first sample past Target.
+	int First = 0;
+	int Count = NumSamples;
+	while (Count > 0)
+	{
+		const int Half = Count / 2;
+		if (GetDistance(First + Half) <= Target)
+		{
+			First += Half + 1;
+			Count -= Half + 1;
+		}
+		else
+		{
+			Count = Half;
+		}
+	}
+	return FMath::Clamp(First - 1, 0, LastBracket);
+}
+
+FSGSplineCursor::FSGSplineCursor(const USplineComponent* InSpline)
+{
+	Reset(InSpline);
+}
+
+void FSGSplineCursor::Reset(const USplineComponent* InSpline)
+{
+	Spline = InSpline;
+	SGSpline = Cast<USGSplineComponent>(InSpline);
+	Table = ETable::Reparam;
+	Revision = SGSpline ? SGSpline->GetSplineRevision() : 0;
+	Bracket = 0;
+	Segment = 0;
+	LastLocalTarget = -1.0;
+	LastT = -1.0;
+}
+
+void FSGSplineCursor::Validate()
+{
+	if (!SGSpline) return;
+	SGSpline->EnsureDerivedData();
+
+	ETable NewTable = ETable::Reparam;
+	if (SGSpline->ArcLengthMode == ESGArcLengthMode::Exact && SGSpline->HasExactArcLengths()) NewTable = ETable::Exact;
+	else if (SGSpline->ArcLengthMode == ESGArcLengthMode::AdaptiveTable && SGSpline->HasAdaptiveReparamTable()) NewTable = ETable::Adaptive;
+
+	if (NewTable != Table || SGSpline->GetSplineRevision() != Revision)
+	{
+		Table = NewTable;
+		Revision = SGSpline->GetSplineRevision();
+		Bracket = 0;
+		LastLocalTarget = -1.0;
+		LastT = -1.0;
+	}
+}
+
+float FSGSplineCursor::GetInputKeyAtDistance(float Distance)
+{
+	if (!Spline) return 0.f;
+	Validate();
+
+	if (Table == ETable::Exact)
+	{
+		const TArray<double>& Distances = SGSpline->ExactSegmentDistances;
+		const double Target = FMath::Clamp(double(Distance), 0.0, Distances.Last());
+		const int PreviousBracket = Bracket;
+		Bracket = SGAdvanceBracket(Bracket, Distances.Num(), Target, [&Distances](int i) { return Distances[i]; });
+		Segment = Bracket;
+		const double SegmentStart = Distances[Bracket];
+		const double SegmentLength = Distances[Bracket + 1] - SegmentStart;
+		if (SegmentLength <= UE_SMALL_NUMBER) return float(Bracket);
+
+		// Within the same segment the last solution plus the distance moved is a closer guess than the linear one.
+		const double LocalTarget = Target - SegmentStart;
+		double GuessT = LocalTarget / SegmentLength;
+		if (Bracket == PreviousBracket && LastT >= 0.0) GuessT = LastT + (LocalTarget - LastLocalTarget) / SegmentLength;
+		LastT = SGSpline->SolveExactSegmentT(Bracket, LocalTarget, GuessT);
+		LastLocalTarget = LocalTarget;
+		return float(Bracket + LastT);
+	}
+
+	if (Table == ETable::Adaptive)
+	{
+		const TArray<double>& Distances = SGSpline->AdaptiveReparamDistances;
+		const TArray<float>& Keys = SGSpline->AdaptiveReparamKeys;
+		const double Target = FMath::Clamp(double(Distance), 0.0, Distances.Last());
+		Bracket = SGAdvanceBracket(Bracket, Distances.Num(), Target, [&Distances](int i) { return Distances[i]; });
+		const double Span = Distances[Bracket + 1] - Distances[Bracket];
+		const float Alpha = Span > UE_SMALL_NUMBER ? float((Target - Distances[Bracket]) / Span) : 0.f;
+		const float Key = FMath::Lerp(Keys[Bracket], Keys[Bracket + 1], Alpha);
+		Segment = FMath::FloorToInt(Key);
+		return Key;
+	}
+
+	// Same result as FInterpCurveFloat::Eval on the linear reparam table, clamped at both ends.
+	const TArray<FInterpCurvePoint<float>>& Points = Spline->SplineCurves.ReparamTable.Points;
+	if (Points.Num() == 0) return 0.f;
+	if (Points.Num() == 1 || Distance <= Points[0].InVal)
+	{
+		Segment = 0;
+		return Points[0].OutVal;
+	}
+	if (Distance >= Points.Last().InVal)
+	{
+		Segment = FMath::FloorToInt(Points.Last().OutVal);
+		return Points.Last().OutVal;
+	}
+	Bracket = SGAdvanceBracket(Bracket, Points.Num(), Distance, [&Points](int i) { return double(Points[i].InVal); });
+	const float Span = Points[Bracket + 1].InVal - Points[Bracket].InVal;
+	const float Alpha = Span > 0.f ? (Distance - Points[Bracket].InVal) / Span : 0.f;
+	const float Key = FMath::Lerp(Points[Bracket].OutVal, Points[Bracket + 1].OutVal, Alpha);
+	Segment = FMath::FloorToInt(Key);
+	return Key;
+}
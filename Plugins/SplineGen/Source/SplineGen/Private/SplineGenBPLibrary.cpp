@@ -2,6 +2,9 @@
 
 #include "SplineGenBPLibrary.h"
 #include "SplineGen.h"
+#include "SGEasing.h"
+#include "SGSplineCursor.h"
+#include "SGCSVImport.h"
 
 USplineGenBPLibrary::USplineGenBPLibrary(const FObjectInitializer& ObjectInitializer)
 : Super(ObjectInitializer)
@@ -30,6 +33,7 @@ const int USplineGenBPLibrary::GetPreviousSplinePoint(const USplineComponent* Sp
 const float USplineGenBPLibrary::GetSegmentLength(const USplineComponent* Spline, const int SplinePoint)
 {
 	if (!Spline) return -1.f;
+	if (const USGSplineComponent* SGSpline = Cast<USGSplineComponent>(Spline)) return SGSpline->GetSegmentLength(SplinePoint);
 	float Start = Spline->GetDistanceAlongSplineAtSplinePoint(SplinePoint);
 	float End = Spline->GetDistanceAlongSplineAtSplinePoint(GetNextSplinePoint(Spline, SplinePoint));
 	float Length = FMath::Abs(End - Start);
@@ -71,6 +75,79 @@ void USplineGenBPLibrary::SetSplinePoint(USplineComponent* Spline, const int Spl
 	if (bUpdate) Spline->UpdateSpline();
 }
 
+void USplineGenBPLibrary::SetSplinePoints(USplineComponent* Spline, const int StartIndex, const TArray<FSplinePointSetting>& SplinePoints, bool bUpdate)
+{
+	if (!Spline || StartIndex < 0) return;
+	FSplineCurves& Curves = Spline->SplineCurves;
+
+	// Grow every curve once, with the same defaults AddSplinePoint gives new points.
+	const int OldNum = Curves.Position.Points.Num();
+	const int NewNum = FMath::Max(OldNum, StartIndex + SplinePoints.Num());
+	if (NewNum > OldNum)
+	{
+		Curves.Position.Points.Reserve(NewNum);
+		Curves.Rotation.Points.Reserve(NewNum);
+		Curves.Scale.Points.Reserve(NewNum);
+		for (int i = OldNum; i < NewNum; i++)
+		{
+			Curves.Position.Points.Emplace(float(i), FVector::ZeroVector, FVector::ZeroVector, FVector::ZeroVector, CIM_CurveAuto);
+			Curves.Rotation.Points.Emplace(float(i), FQuat::Identity, FQuat::Identity, FQuat::Identity, CIM_CurveAuto);
+			Curves.Scale.Points.Emplace(float(i), FVector(1.0f), FVector::ZeroVector, FVector::ZeroVector, CIM_CurveAuto);
+		}
+	}
+
+	// Same results as the per-point setters used by SetSplinePoint, without their per-call bookkeeping.
+	const FTransform& ComponentTransform = Spline->GetComponentTransform();
+	const ESplineCoordinateSpace::Type WS = ESplineCoordinateSpace::World;
+	for (int i = 0; i < SplinePoints.Num(); i++)
+	{
+		const FSplinePointSetting& SplinePointData = SplinePoints[i];
+		const int Index = StartIndex + i;
+		const FVector Location = (SplinePointData.LocationCoordSpace == WS) ? ComponentTransform.InverseTransformPosition(SplinePointData.Location) : SplinePointData.Location;
+		const FVector UpVector = (SplinePointData.UpVectorCoordSpace == WS) ? ComponentTransform.InverseTransformVector(SplinePointData.UpVector.GetSafeNormal()) : SplinePointData.UpVector.GetSafeNormal();
+		const FVector Tangent = (SplinePointData.TangentCoordSpace == WS) ? ComponentTransform.InverseTransformVector(SplinePointData.Tangent) : SplinePointData.Tangent;
+
+		FInterpCurvePoint<FVector>& PositionPoint = Curves.Position.Points[Index];
+		PositionPoint.OutVal = Location;
+		PositionPoint.ArriveTangent = Tangent;
+		PositionPoint.LeaveTangent = Tangent;
+		PositionPoint.InterpMode = CIM_CurveUser;
+		Curves.Rotation.Points[Index].OutVal = FQuat::FindBetween(Spline->DefaultUpVector, UpVector);
+		Curves.Scale.Points[Index].OutVal = SplinePointData.Scale;
+	}
+	if (bUpdate) Spline->UpdateSpline();
+}
+
+bool USplineGenBPLibrary::ImportCSVTrack(USGSplineComponent* Spline, const FString& Filename, FString& OutError, float PositionScale, bool bConvertFromYUp, bool bClosedLoop)
+{
+	if (!Spline)
+	{
+		OutError = TEXT("No spline to import into.");
+		return false;
+	}
+	const double StartTime = FPlatformTime::Seconds();
+	TArray<FSplinePointSetting> Points;
+	if (!SGCSVImport::ReadTrackFile(Filename, PositionScale, bConvertFromYUp, bClosedLoop, Points, OutError))
+	{
+		UE_LOG(LogTemp, Display, TEXT("CSV track import failed: %s"), *OutError);
+		return false;
+	}
+	const double ParsedTime = FPlatformTime::Seconds();
+
+	Spline->ClearSplinePoints(false);
+	SetSplinePoints(Spline, 0, Points, false);
+	Spline->SetClosedLoop(bClosedLoop, false);
+	Spline->UpdateSpline();
+	const double EndTime = FPlatformTime::Seconds();
+
+	const double ParseSeconds = FMath::Max(ParsedTime - StartTime, UE_SMALL_NUMBER);
+	const double TotalSeconds = FMath::Max(EndTime - StartTime, UE_SMALL_NUMBER);
+	UE_LOG(LogTemp, Display, TEXT("Imported %i CSV rows in %.2f ms: parse %.0f rows/s, total %.0f rows/s (spline update %.2f ms)."),
+		Points.Num(), TotalSeconds * 1000.0, Points.Num() / ParseSeconds, Points.Num() / TotalSeconds, (EndTime - ParsedTime) * 1000.0);
+	OutError.Reset();
+	return true;
+}
+
 bool USplineGenBPLibrary::TrimSpline(USplineComponent* Spline, const int NewLastIndex)
 {
 	if (!Spline) return false;
@@ -159,138 +236,95 @@ FMeshSplineDivisions USplineGenBPLibrary::CalcMeshSplineDivisionsFromUserSplineS
 	return SplineDivisions;
 }
 
-int USplineGenBPLibrary::UpdateMeshSplineSection(const USplineComponent* UserSpline, const USplineComponent* GenRefSpline, USplineComponent* GenMeshSpline, const int UserSplinePoint, const int MeshSplineStartingPoint, const float TargetMeshSegmentLength, const bool bClearSpline, const bool bGenSplineDivisions, FMeshSplineDivisions SplineDivisions, const FRollConfig& RollConfig)
+void USplineGenBPLibrary::GetMeshSplineSectionPoints(const USplineComponent* UserSpline, const int UserSplinePoint, FMeshSplineDivisions SplineDivisions, TArray<FSplinePointSetting>& OutPoints)
 {
-	if (UserSplinePoint < 0) return 0;
-	if (bGenSplineDivisions) SplineDivisions = CalcMeshSplineDivisionsFromUserSplineSegment(UserSpline, GenMeshSpline, UserSplinePoint, TargetMeshSegmentLength);
-	if (bClearSpline) GenMeshSpline->ClearSplinePoints(true);
+	OutPoints.Reset();
+	if (!UserSpline || UserSplinePoint < 0) return;
 
 	ESplineCoordinateSpace::Type WS = ESplineCoordinateSpace::World;
 	ESplineCoordinateSpace::Type LS = ESplineCoordinateSpace::Local;
 
+	const USGSplineComponent* CastedUserSpline = Cast<USGSplineComponent>(UserSpline);
 	float StartingDistanceOnUserSpline = UserSpline->GetDistanceAlongSplineAtSplinePoint(UserSplinePoint);
+	if (CastedUserSpline && UserSplinePoint < UserSpline->GetNumberOfSplineSegments()) StartingDistanceOnUserSpline = CastedUserSpline->GetSegmentLayout(UserSplinePoint).StartDistance;
 
 	//UE_LOG(LogTemp, Display, TEXT("UpdateMeshSplineSection Init Success. UserSplinePoint: %i, MeshSegmentLength: %f, StartingDistanceOnUserSpline: %f"), UserSplinePoint, SplineDivisions.ResultSegmentLength, StartingDistanceOnUserSpline);
 	//UE_LOG(LogTemp, Display, TEXT("Update Section UserSplinePoint: %i, Divisions: %i"), UserSplinePoint, SplineDivisions.SegmentsCount);
 
-	int MinPointsNeeded = MeshSplineStartingPoint + SplineDivisions.SegmentsCount;
-
 	float UseDistanceOnSpline = 0.f;
-	int CurrentPointOnMeshSpline = 0;
 	FSplinePointSetting UseSplinePoint;
+	UseSplinePoint.LocationCoordSpace = WS;
+	UseSplinePoint.UpVectorCoordSpace = WS;
+	UseSplinePoint.TangentCoordSpace = WS;
+	OutPoints.Reserve(SplineDivisions.SegmentsCount + 1);
+	FSGSplineCursor Cursor(UserSpline);
 	for (int i = 0; i <= SplineDivisions.SegmentsCount; i++)
 	{
 		UseDistanceOnSpline = (i * SplineDivisions.ResultSegmentLength) + StartingDistanceOnUserSpline;
-
-		//FVector LocationOnRefSpline = GenRefSpline->GetLocationAtDistanceAlongSpline(UseDistanceOnSpline, WS);
-		/*FVector UpVectorStart = UserSpline->GetUpVectorAtSplinePoint(UserSplinePoint, WS).GetSafeNormal();
-		FVector UpVectorEnd = UserSpline->GetUpVectorAtSplinePoint(GetNextSplinePoint(UserSpline, UserSplinePoint), WS).GetSafeNormal();
-		float Key = float(i) / float(SplineDivisions.SegmentsCount);
-		/*if (RollConfig.EaseType == EInterpInOutType::AutoEase)
-		{
-			float Incoming = UserSpline->GetLeaveTangentAtSplinePoint(UserSplinePoint, LS).Length();
-			float Outgoing = UserSpline->GetArriveTangentAtSplinePoint(GetNextSplinePoint(UserSpline, UserSplinePoint), LS).Length();
-			float AverageLength = (Incoming + Outgoing) * 0.5f;
-			TRange<float> InRange = TRange<float>(0.f, 1000.f);
-			TRange<float> OutRange = TRange<float>(0.f, 3.f);
-			float NewEaseExp = FMath::GetMappedRangeValueClamped(InRange, OutRange, AverageLength);
-			FRollConfig NewRollConfig = FRollConfig(EInterpInOutType::AutoEase, EInterpInOutSelection::EaseInOut, NewEaseExp);
-			Key = SelectEaseInterp(0.f, 1.f, Key, NewRollConfig);
-		}
-		else Key = SelectEaseInterp(0.f, 1.f, Key, RollConfig);*/
-		/*float StartTanLen = UserSpline->GetLeaveTangentAtSplinePoint(UserSplinePoint, ESplineCoordinateSpace::Local).Length();
-		float EndTanLen = UserSpline->GetArriveTangentAtSplinePoint(GetNextSplinePoint(UserSpline, UserSplinePoint), ESplineCoordinateSpace::Local).Length();
-		float SegLen = GetSegmentLength(UserSpline, UserSplinePoint);
-		Key = GenRollCurve(Key, 0.f, 1.f, StartTanLen, EndTanLen, SegLen);
-		*/
-		UseSplinePoint.LocationCoordSpace = WS;
-		UseSplinePoint.UpVectorCoordSpace = WS;
-		UseSplinePoint.TangentCoordSpace = WS;
-		UseSplinePoint.Location = UserSpline->GetLocationAtDistanceAlongSpline(UseDistanceOnSpline, WS);
-		const USGSplineComponent* CastedUserSpline = Cast<USGSplineComponent>(UserSpline);
-		if (CastedUserSpline) UseSplinePoint.UpVector = CastedUserSpline->GetCorrectUpVectorAtDistanceAlongSpline(UseDistanceOnSpline, WS);
-		else UseSplinePoint.UpVector = UserSpline->GetUpVectorAtDistanceAlongSpline(UseDistanceOnSpline, WS);
+		const float Key = Cursor.GetInputKeyAtDistance(UseDistanceOnSpline);
+		UseSplinePoint.Location = UserSpline->GetLocationAtSplineInputKey(Key, WS);
+		if (CastedUserSpline) UseSplinePoint.UpVector = CastedUserSpline->GetCorrectUpVectorAtSplineInputKey(Key, WS);
+		else UseSplinePoint.UpVector = UserSpline->GetUpVectorAtSplineInputKey(Key, WS);
 		//UseSplinePoint.UpVector = FVector::SlerpVectorToDirection(UpVectorStart, UpVectorEnd, Key).GetSafeNormal();
 		//UseSplinePoint.UpVector = UserSpline->GetUpVectorAtDistanceAlongSpline(UseDistanceOnSpline, WS);
-		//UE_LOG(LogTemp, Display, TEXT("Key: %f"), Key);
 		//UseSplinePoint.UpVector = (LocationOnRefSpline - UseSplinePoint.Location).GetSafeNormal();
-		UseSplinePoint.Tangent = UserSpline->GetTangentAtDistanceAlongSpline(UseDistanceOnSpline, WS) / SplineDivisions.SegmentsCount;
-		UseSplinePoint.Scale = UserSpline->GetScaleAtDistanceAlongSpline(UseDistanceOnSpline);
-		CurrentPointOnMeshSpline = i + MeshSplineStartingPoint;
-		SetSplinePoint(GenMeshSpline, CurrentPointOnMeshSpline, UseSplinePoint, true);
-		//UE_LOG(LogTemp, Display, TEXT("Set Spline Point Current Point On Mesh Spline: %i"), CurrentPointOnMeshSpline);
+		UseSplinePoint.Tangent = UserSpline->GetTangentAtSplineInputKey(Key, WS) / SplineDivisions.SegmentsCount;
+		UseSplinePoint.Scale = UserSpline->GetScaleAtSplineInputKey(Key);
+		OutPoints.Add(UseSplinePoint);
 		//UE_LOG(LogTemp, Display, TEXT("Add/Set Mesh Point %i @ Location: %s, UpVector: %s, Tangent: %s"), i, *UseSplinePoint.Location.ToString(), *UseSplinePoint.UpVector.ToString(), *UseSplinePoint.Tangent.ToString());
 	}
-	GenMeshSpline->UpdateSpline();
+}
+
+int USplineGenBPLibrary::UpdateMeshSplineSection(const USplineComponent* UserSpline, const USplineComponent* GenRefSpline, USplineComponent* GenMeshSpline, const int UserSplinePoint, const int MeshSplineStartingPoint, const float TargetMeshSegmentLength, const bool bClearSpline, const bool bGenSplineDivisions, FMeshSplineDivisions SplineDivisions, const FRollConfig& RollConfig)
+{
+	if (UserSplinePoint < 0) return 0;
+	if (bGenSplineDivisions) SplineDivisions = CalcMeshSplineDivisionsFromUserSplineSegment(UserSpline, GenMeshSpline, UserSplinePoint, TargetMeshSegmentLength);
+	if (bClearSpline) GenMeshSpline->ClearSplinePoints(true);
+
+	/*if (RollConfig.EaseType == EInterpInOutType::AutoEase)
+	{
+		float Incoming = UserSpline->GetLeaveTangentAtSplinePoint(UserSplinePoint, LS).Length();
+		float Outgoing = UserSpline->GetArriveTangentAtSplinePoint(GetNextSplinePoint(UserSpline, UserSplinePoint), LS).Length();
+		float AverageLength = (Incoming + Outgoing) * 0.5f;
+		TRange<float> InRange = TRange<float>(0.f, 1000.f);
+		TRange<float> OutRange = TRange<float>(0.f, 3.f);
+		float NewEaseExp = FMath::GetMappedRangeValueClamped(InRange, OutRange, AverageLength);
+		FRollConfig NewRollConfig = FRollConfig(EInterpInOutType::AutoEase, EInterpInOutSelection::EaseInOut, NewEaseExp);
+		Key = SelectEaseInterp(0.f, 1.f, Key, NewRollConfig);
+	}
+	else Key = SelectEaseInterp(0.f, 1.f, Key, RollConfig);*/
+
+	TArray<FSplinePointSetting> SectionPoints;
+	GetMeshSplineSectionPoints(UserSpline, UserSplinePoint, SplineDivisions, SectionPoints);
+	SetSplinePoints(GenMeshSpline, MeshSplineStartingPoint, SectionPoints, true);
 	return SplineDivisions.SegmentsCount;
 }
 
-const float USplineGenBPLibrary::SelectEaseInterp(const float A, const float B, const float Alpha, const FRollConfig& RollConfig)
+// Blueprint loops call SelectEaseInterp once per point with the same config, so keep the last resolved config per thread like GetRollCurveEase does.
+static const FSGEasing& GetSelectedEasing(const FRollConfig& RollConfig)
 {
-	if (RollConfig.InOut == EInterpInOutSelection::None || RollConfig.EaseType == EInterpInOutType::Linear) return Alpha;
-	switch (RollConfig.EaseType)
+	static thread_local FRollConfig CachedConfig;
+	static thread_local FSGEasing CachedEasing(CachedConfig);
+	if (CachedConfig.EaseType != RollConfig.EaseType || CachedConfig.InOut != RollConfig.InOut || CachedConfig.EaseExp != RollConfig.EaseExp)
 	{
-		case EInterpInOutType::Circular:
-			switch (RollConfig.InOut)
-			{
-			case EInterpInOutSelection::EaseIn:
-				return FMath::InterpCircularIn(A, B, Alpha);
-			break;
-			case EInterpInOutSelection::EaseOut:
-				return FMath::InterpCircularOut(A, B, Alpha);
-			break;
-			case EInterpInOutSelection::EaseInOut:
-				return FMath::InterpCircularInOut(A, B, Alpha);
-			break;
-			}
-		break;
-		case EInterpInOutType::Ease:
-			switch (RollConfig.InOut)
-			{
-			case EInterpInOutSelection::EaseIn:
-				return FMath::InterpEaseIn(A, B, Alpha, RollConfig.EaseExp);
-			break;
-			case EInterpInOutSelection::EaseOut:
-				return FMath::InterpEaseOut(A, B, Alpha, RollConfig.EaseExp);
-			break;
-			case EInterpInOutSelection::EaseInOut:
-				return FMath::InterpEaseInOut(A, B, Alpha, RollConfig.EaseExp);
-			break;
-			}
-		break;
-		case EInterpInOutType::Expo:
-			switch (RollConfig.InOut)
-			{
-			case EInterpInOutSelection::EaseIn:
-				return FMath::InterpExpoIn(A, B, Alpha);
-			break;
-			case EInterpInOutSelection::EaseOut:
-				return FMath::InterpExpoOut(A, B, Alpha);
-			break;
-			case EInterpInOutSelection::EaseInOut:
-				return FMath::InterpExpoInOut(A, B, Alpha);
-			break;
-			}
-		break;
-		case EInterpInOutType::Sine:
-			switch (RollConfig.InOut)
-			{
-			case EInterpInOutSelection::EaseIn:
-				return FMath::InterpSinIn(A, B, Alpha);
-			break;
-			case EInterpInOutSelection::EaseOut:
-				return FMath::InterpSinOut(A, B, Alpha);
-			break;
-			case EInterpInOutSelection::EaseInOut:
-				return FMath::InterpSinInOut(A, B, Alpha);
-			break;
-			}
-		break;
-		case EInterpInOutType::AutoEase:
-			return FMath::InterpEaseInOut(A, B, Alpha, RollConfig.EaseExp);
-		break;
+		CachedConfig = RollConfig;
+		CachedEasing = FSGEasing(RollConfig);
 	}
-	return Alpha;
+	return CachedEasing;
+}
+
+const float USplineGenBPLibrary::SelectEaseInterp(const float A, const float B, const float Alpha, const FRollConfig& RollConfig)
+{
+	if (RollConfig.InOut == EInterpInOutSelection::None || RollConfig.EaseType == EInterpInOutType::Linear) return Alpha;
+	return FMath::Lerp(A, B, GetSelectedEasing(RollConfig).Eval(Alpha));
+}
+
+void USplineGenBPLibrary::SelectEaseInterpArray(const float A, const float B, TArray<float>& Alphas, const FRollConfig& RollConfig)
+{
+	const FSGEasing Easing(RollConfig);
+	if (Easing.IsLinear()) return;
+	Easing.EvalArray(Alphas);
+	for (float& Alpha : Alphas) Alpha = FMath::Lerp(A, B, Alpha);
 }
 
 const int USplineGenBPLibrary::FindMeshSplineStartingPointFromUserPoint(const USplineComponent* UserSpline, const USplineComponent* GenMeshSpline, const int ControlPointOnUserSpline)
@@ -305,27 +339,49 @@ const int USplineGenBPLibrary::FindMeshSplineStartingPointFromUserPoint(const US
 	return PointOnFinalSpline;
 }
 
-void USplineGenBPLibrary::SplineShiftPoints(USplineComponent* Spline, int StartingPoint, int Shift, bool bUpdateSpline)
+// Inserts (Shift > 0) or removes (Shift < 0) a run of points at StartingPoint in one array operation, then re-keys the points after it.
+template<typename T>
+static void ShiftCurvePoints(TArray<FInterpCurvePoint<T>>& Points, const int StartingPoint, const int Shift, const T& DefaultValue, const T& DefaultTangent)
 {
-	if (!Spline) return;
-	if (!IsSplinePointInRange(Spline, StartingPoint) || Shift == 0) return;
-	int NextPoint = GetNextSplinePoint(Spline, StartingPoint);
-	FVector LocationLS = Spline->GetLocationAtSplinePoint(StartingPoint, ESplineCoordinateSpace::Local);
 	if (Shift > 0)
 	{
-		for (int i = 0; i < Shift; i++)
+		Points.InsertDefaulted(StartingPoint, Shift);
+		for (int i = StartingPoint; i < StartingPoint + Shift; i++)
 		{
-			Spline->AddSplinePointAtIndex(FVector::ZeroVector, StartingPoint, ESplineCoordinateSpace::Local, bUpdateSpline);
+			Points[i] = FInterpCurvePoint<T>(0.f, DefaultValue, DefaultTangent, DefaultTangent, CIM_CurveAuto);
 		}
 	}
 	else if (Shift < 0)
 	{
-		int AbsShift = FMath::Abs(Shift);
-		for (int i = 0; i < AbsShift; i++)
-		{
-			Spline->RemoveSplinePoint(StartingPoint, bUpdateSpline);
-		}
+		Points.RemoveAt(StartingPoint, FMath::Min(-Shift, Points.Num() - StartingPoint));
+	}
+	for (int i = StartingPoint; i < Points.Num(); i++) Points[i].InVal = float(i);
+}
+
+void USplineGenBPLibrary::SplineShiftPoints(USplineComponent* Spline, int StartingPoint, int Shift, bool bUpdateSpline)
+{
+	if (!Spline) return;
+	if (!IsSplinePointInRange(Spline, StartingPoint) || Shift == 0) return;
+
+	// Same defaults AddSplinePointAtIndex gives inserted points.
+	FSplineCurves& Curves = Spline->SplineCurves;
+	const int NumPoints = Curves.Position.Points.Num();
+	ShiftCurvePoints(Curves.Position.Points, StartingPoint, Shift, FVector::ZeroVector, FVector::ZeroVector);
+	ShiftCurvePoints(Curves.Rotation.Points, StartingPoint, Shift, FQuat::Identity, FQuat::Identity);
+	ShiftCurvePoints(Curves.Scale.Points, StartingPoint, Shift, FVector(1.0f), FVector::ZeroVector);
+
+	// Keep the derived up vector spline lined up with the points until it's next rebuilt.
+	USGSplineComponent* SGSpline = Cast<USGSplineComponent>(Spline);
+	if (SGSpline && SGSpline->SplineCurveUpVector.Points.Num() == NumPoints)
+	{
+		ShiftCurvePoints(SGSpline->SplineCurveUpVector.Points, StartingPoint, Shift, FVector::UpVector, FVector::ZeroVector);
 	}
+	if (SGSpline && SGSpline->SplineCurveRoll.Points.Num() == NumPoints)
+	{
+		ShiftCurvePoints(SGSpline->SplineCurveRoll.Points, StartingPoint, Shift, 0.f, 0.f);
+	}
+
+	if (bUpdateSpline) Spline->UpdateSpline();
 }
 
 int USplineGenBPLibrary::UpdateMeshSpline(const USplineComponent* UserSpline, const USplineComponent* GenRefSpline, USplineComponent* GenMeshSpline, const int UserSplinePoint, int MeshSplineStartPoint, const float TargetMeshSegmentLength, const int PreviousSegmentCount, const bool bClearMeshSpline, const FRollConfig& RollConfig)
@@ -343,7 +399,8 @@ int USplineGenBPLibrary::UpdateMeshSpline(const USplineComponent* UserSpline, co
 		int Shift = SplineDivisions.SegmentsCount - PreviousSegmentCount;
 		if (Shift != 0)
 		{
-			SplineShiftPoints(GenMeshSpline, MeshSplineStartPoint, Shift, true);
+			// UpdateMeshSplineSection below writes the section and updates the spline, so that's the one rebuild.
+			SplineShiftPoints(GenMeshSpline, MeshSplineStartPoint, Shift, false);
 			//UE_LOG(LogTemp, Display, TEXT("Shift: %i on: %i"), Shift, UserSplinePoint);
 		}
 	}
@@ -381,21 +438,42 @@ void USplineGenBPLibrary::InitRefSpline(const USplineComponent* UserSpline, USpl
 	}
 }
 
-void USplineGenBPLibrary::InitMeshSpline(const USplineComponent* UserSpline, const USplineComponent* GenRefSpline, USplineComponent* GenMeshSpline, TArray<int>& SplinePointMap, TArray<int>& SegmentCountMap, const float TargetMeshSegmentLength, const TArray<FRollConfig>& RollConfigs)
+// Generates every section of the mesh spline with one bulk write, returning the mesh spline segment count per user segment.
+static void InitMeshSplinePoints(const USplineComponent* UserSpline, USplineComponent* GenMeshSpline, const float TargetMeshSegmentLength, TArray<int>& OutSegmentCounts)
 {
-	GenMeshSpline->ClearSplinePoints(true);
-	SplinePointMap = { 0 };
-	SegmentCountMap = {};
+	GenMeshSpline->ClearSplinePoints(false);
+	OutSegmentCounts.Reset();
 	int CurrentMeshSplineStartPoint = 0;
-	int CurrentPreviousSegmentCount = 0;
+	TArray<FSplinePointSetting> AllPoints;
+	TArray<FSplinePointSetting> SectionPoints;
 	for (int i = 0; i < UserSpline->GetNumberOfSplineSegments(); i++)
 	{
-		CurrentPreviousSegmentCount = UpdateMeshSpline(UserSpline, GenRefSpline, GenMeshSpline, i, CurrentMeshSplineStartPoint, TargetMeshSegmentLength, CurrentPreviousSegmentCount, false, GetRollConfig(RollConfigs, i));
-		CurrentMeshSplineStartPoint += CurrentPreviousSegmentCount;
-		SegmentCountMap.Add(CurrentPreviousSegmentCount);
-		SplinePointMap.Add(CurrentMeshSplineStartPoint);
-		UE_LOG(LogTemp, Display, TEXT("Add to mesh spline: %i"), i);
+		FMeshSplineDivisions SplineDivisions = USplineGenBPLibrary::CalcMeshSplineDivisionsFromUserSplineSegment(UserSpline, GenMeshSpline, i, TargetMeshSegmentLength);
+		USplineGenBPLibrary::GetMeshSplineSectionPoints(UserSpline, i, SplineDivisions, SectionPoints);
+		// Each section's first point overwrites the previous section's last point, same as writing them one section at a time.
+		AllPoints.SetNum(CurrentMeshSplineStartPoint);
+		AllPoints.Append(SectionPoints);
+		CurrentMeshSplineStartPoint += SplineDivisions.SegmentsCount;
+		OutSegmentCounts.Add(SplineDivisions.SegmentsCount);
 	}
+	USplineGenBPLibrary::SetSplinePoints(GenMeshSpline, 0, AllPoints, true);
+	UE_LOG(LogTemp, Display, TEXT("Init mesh spline: %i points from %i user segments"), AllPoints.Num(), OutSegmentCounts.Num());
+}
+
+void USplineGenBPLibrary::InitMeshSpline(const USplineComponent* UserSpline, const USplineComponent* GenRefSpline, USplineComponent* GenMeshSpline, TArray<int>& SplinePointMap, TArray<int>& SegmentCountMap, const float TargetMeshSegmentLength, const TArray<FRollConfig>& RollConfigs)
+{
+	TArray<int> SegmentCounts;
+	InitMeshSplinePoints(UserSpline, GenMeshSpline, TargetMeshSegmentLength, SegmentCounts);
+	FMeshSplinePointIndex PointIndex;
+	PointIndex.Reset(SegmentCounts);
+	PointIndex.ToMaps(SplinePointMap, SegmentCountMap);
+}
+
+void USplineGenBPLibrary::InitMeshSplineIndexed(const USplineComponent* UserSpline, const USplineComponent* GenRefSpline, USplineComponent* GenMeshSpline, FMeshSplinePointIndex& PointIndex, const float TargetMeshSegmentLength, const TArray<FRollConfig>& RollConfigs)
+{
+	TArray<int> SegmentCounts;
+	InitMeshSplinePoints(UserSpline, GenMeshSpline, TargetMeshSegmentLength, SegmentCounts);
+	PointIndex.Reset(SegmentCounts);
 }
 
 int USplineGenBPLibrary::SetMeshSplineRegionFromUserSplineSegment(const USplineComponent* UserSpline, const USplineComponent* GenRefSpline, USplineComponent* GenMeshSpline, const int UserSplinePoint, TArray<int>& SplinePointMap, TArray<int>& SegmentCountMap, const float TargetMeshSegmentLength, const TArray<FRollConfig>& RollConfigs)
@@ -450,8 +528,7 @@ void USplineGenBPLibrary::SetSingleSplineMesh(const USplineComponent* Spline, co
 void USplineGenBPLibrary::InitSplineMesh(const USplineComponent* GenMeshSpline, UStaticMesh* Mesh, TArray<UMaterialInterface*>& Materials, TArray<USplineMeshComponent*>& SplineMeshes, AActor* Actor)
 {
 	if (!Actor || !Mesh || !Materials.IsValidIndex(0)) return;
-	for (int i = 0; i < SplineMeshes.Num(); i++) if (SplineMeshes[i]) SplineMeshes[i]->DestroyComponent(false);
-	SplineMeshes.Empty();
+	DestroySplineMeshes(SplineMeshes);
 	for (int i = 0; i < GenMeshSpline->GetNumberOfSplineSegments(); i++)
 	{
 		FString ComponentName = "TrackSplineMeshComponent" + FString::FromInt(0) + "_" + FString::FromInt(i);
@@ -473,56 +550,49 @@ void USplineGenBPLibrary::InitSplineMesh(const USplineComponent* GenMeshSpline,
 	}
 }
 
-void USplineGenBPLibrary::UpdateSplineMeshRegion(const USplineComponent* UserSpline, const USplineComponent* GenMeshSpline, const int UserSegment, const int Shift, TArray<int>& SplinePointMap, TArray<int>& SegmentCountMap, UPARAM(ref)TArray<USplineMeshComponent*>& SplineMeshes, AActor* Actor, UStaticMesh* Mesh, TArray<UMaterialInterface*>& Materials)//segment map, spline point map, spline meshes, user segment
+int USplineGenBPLibrary::SetMeshSplineRegionFromUserSplineSegmentIndexed(const USplineComponent* UserSpline, const USplineComponent* GenRefSpline, USplineComponent* GenMeshSpline, const int UserSplinePoint, FMeshSplinePointIndex& PointIndex, const float TargetMeshSegmentLength, const TArray<FRollConfig>& RollConfigs)
 {
-	if (!UserSpline || !GenMeshSpline) return;
-	if (!IsSplinePointInRange(UserSpline, UserSegment)) return;
+	if (!UserSpline || !GenRefSpline || !GenMeshSpline) return -1;
+	if (!IsSplinePointInRange(UserSpline, UserSplinePoint)) return -1;
+	if (UserSplinePoint >= PointIndex.Num()) return -1;
+	int PreviousSegmentCount = PointIndex.GetSegmentCount(UserSplinePoint);
+	int NewSegmentCount = UpdateMeshSpline(UserSpline, GenRefSpline, GenMeshSpline, UserSplinePoint, PointIndex.GetStartPoint(UserSplinePoint), TargetMeshSegmentLength, PreviousSegmentCount, false, GetRollConfig(RollConfigs, UserSplinePoint));
+	PointIndex.SetSegmentCount(UserSplinePoint, NewSegmentCount);
+	return NewSegmentCount - PreviousSegmentCount;
+}
 
-	//1. checks, 2. change existing, 3. remove if fewer, 4. add if more, 5. ??
-	int SegmentCount = -1;
-	UE_LOG(LogTemp, Display, TEXT("Update Spline Mesh Region User Segment: %i"), UserSegment);
-	if (!SegmentCountMap.IsValidIndex(UserSegment) || !SplinePointMap.IsValidIndex(UserSegment)) return;
-	//if (/*!SegmentCountMap.IsValidIndex(GetNextSplinePoint(UserSpline,UserSegment)) || */!SplinePointMap.IsValidIndex(GetNextSplinePoint(UserSpline,UserSegment))) return;
-	SegmentCount = SegmentCountMap[UserSegment];
-	UE_LOG(LogTemp, Display, TEXT("Update Spline Mesh Region SegmentCount: %i"), SegmentCount);
-	int StartMeshSplinePoint = -1;
-	int EndMeshSplinePoint = -1;
-	int LastIndex = UserSpline->GetNumberOfSplinePoints() - 1;
-	StartMeshSplinePoint = SplinePointMap[UserSegment];
-	EndMeshSplinePoint = SplinePointMap[GetNextSplinePoint(UserSpline,UserSegment)];
-	int UseEndMeshSplinePoint = GetPreviousSplinePoint(GenMeshSpline, EndMeshSplinePoint);
+// Shared by UpdateSplineMeshRegion and UpdateSplineMeshRegionIndexed once the mesh spline range of the user segment is known.
+static void UpdateSplineMeshRange(const USplineComponent* GenMeshSpline, const int StartMeshSplinePoint, const int EndMeshSplinePoint, const int Shift, TArray<USplineMeshComponent*>& SplineMeshes, AActor* Actor, UStaticMesh* Mesh, TArray<UMaterialInterface*>& Materials)
+{
+	int UseEndMeshSplinePoint = USplineGenBPLibrary::GetPreviousSplinePoint(GenMeshSpline, EndMeshSplinePoint);
 	UE_LOG(LogTemp, Display, TEXT("StartMeshSplinePoint: %i; EndMeshSplinePoint: %i; UseEndMeshSplinePoint: %i"), StartMeshSplinePoint, EndMeshSplinePoint, UseEndMeshSplinePoint);
 	if (Shift > 0)
 	{
-		for (int i = 0; i < Shift; i++)
+		if (SplineMeshes.IsValidIndex(UseEndMeshSplinePoint))
 		{
-			if (SplineMeshes.IsValidIndex(UseEndMeshSplinePoint))
-			{
-				SplineMeshes.EmplaceAt(UseEndMeshSplinePoint);
-			}
-			else
-			{
-				SplineMeshes.Add(nullptr);
-				UE_LOG(LogTemp, Display, TEXT("weird condition: shift > 0, needed to add nullptr to end of SplineMeshes[] array."));
-			}
+			SplineMeshes.InsertZeroed(UseEndMeshSplinePoint, Shift);
+		}
+		else
+		{
+			SplineMeshes.AddZeroed(Shift);
+			UE_LOG(LogTemp, Display, TEXT("weird condition: shift > 0, needed to add nullptr to end of SplineMeshes[] array."));
 		}
 	}
 	else if (Shift < 0)
 	{
+		// Removes the AbsShift meshes ending at UseEndMeshSplinePoint.
 		int AbsShift = FMath::Abs(Shift);
-		for (int i = 0; i < AbsShift; i++)
+		int FirstToRemove = FMath::Max(UseEndMeshSplinePoint - AbsShift + 1, 0);
+		int LastToRemove = FMath::Min(UseEndMeshSplinePoint, SplineMeshes.Num() - 1);
+		if (LastToRemove - FirstToRemove + 1 < AbsShift) UE_LOG(LogTemp, Display, TEXT("bad condition: shift < 0, attempting to remove invalid index for SplineMeshes[] array."));
+		if (LastToRemove >= FirstToRemove)
 		{
-			int Counter = UseEndMeshSplinePoint - i;
-			if (SplineMeshes.IsValidIndex(Counter))
+			for (int i = FirstToRemove; i <= LastToRemove; i++)
 			{
-				if (SplineMeshes[Counter])
-				{
-					SplineMeshes[Counter]->DestroyComponent(false);
-				}
+				if (SplineMeshes[i]) SplineMeshes[i]->DestroyComponent(false);
 				else UE_LOG(LogTemp, Display, TEXT("bad condition: shift < 0, SplineMeshes[] array has valid index, but no valid corresponding SPMesh Component."));
-				SplineMeshes.RemoveAt(Counter);
 			}
-			else UE_LOG(LogTemp, Display, TEXT("bad condition: shift < 0, attempting to remove invalid index for SplineMeshes[] array."));
+			SplineMeshes.RemoveAt(FirstToRemove, LastToRemove - FirstToRemove + 1);
 		}
 	}
 
@@ -553,12 +623,40 @@ void USplineGenBPLibrary::UpdateSplineMeshRegion(const USplineComponent* UserSpl
 			}
 			else UE_LOG(LogTemp, Display, TEXT("bad condition: no valid NewMesh"));
 		}
-		SetSingleSplineMesh(GenMeshSpline, i, SplineMeshes[i], Actor, true);
+		USplineGenBPLibrary::SetSingleSplineMesh(GenMeshSpline, i, SplineMeshes[i], Actor, true);
 		//UE_LOG(LogTemp, Display, TEXT("Set Single Spline Mesh Index: %i"), i);
 		//if (Shift != 0) UE_LOG(LogTemp, Display, TEXT("Set Single Mesh Calc'd Difference: %i, Shift: %i"),EndMeshSplinePoint-StartMeshSplinePoint,Shift);
 	}
 }
 
+void USplineGenBPLibrary::UpdateSplineMeshRegion(const USplineComponent* UserSpline, const USplineComponent* GenMeshSpline, const int UserSegment, const int Shift, TArray<int>& SplinePointMap, TArray<int>& SegmentCountMap, UPARAM(ref)TArray<USplineMeshComponent*>& SplineMeshes, AActor* Actor, UStaticMesh* Mesh, TArray<UMaterialInterface*>& Materials)//segment map, spline point map, spline meshes, user segment
+{
+	if (!UserSpline || !GenMeshSpline) return;
+	if (!IsSplinePointInRange(UserSpline, UserSegment)) return;
+
+	//1. checks, 2. change existing, 3. remove if fewer, 4. add if more, 5. ??
+	int SegmentCount = -1;
+	UE_LOG(LogTemp, Display, TEXT("Update Spline Mesh Region User Segment: %i"), UserSegment);
+	if (!SegmentCountMap.IsValidIndex(UserSegment) || !SplinePointMap.IsValidIndex(UserSegment)) return;
+	//if (/*!SegmentCountMap.IsValidIndex(GetNextSplinePoint(UserSpline,UserSegment)) || */!SplinePointMap.IsValidIndex(GetNextSplinePoint(UserSpline,UserSegment))) return;
+	SegmentCount = SegmentCountMap[UserSegment];
+	UE_LOG(LogTemp, Display, TEXT("Update Spline Mesh Region SegmentCount: %i"), SegmentCount);
+	int StartMeshSplinePoint = -1;
+	int EndMeshSplinePoint = -1;
+	int LastIndex = UserSpline->GetNumberOfSplinePoints() - 1;
+	StartMeshSplinePoint = SplinePointMap[UserSegment];
+	EndMeshSplinePoint = SplinePointMap[GetNextSplinePoint(UserSpline,UserSegment)];
+	UpdateSplineMeshRange(GenMeshSpline, StartMeshSplinePoint, EndMeshSplinePoint, Shift, SplineMeshes, Actor, Mesh, Materials);
+}
+
+void USplineGenBPLibrary::UpdateSplineMeshRegionIndexed(const USplineComponent* UserSpline, const USplineComponent* GenMeshSpline, const int UserSegment, const int Shift, const FMeshSplinePointIndex& PointIndex, TArray<USplineMeshComponent*>& SplineMeshes, AActor* Actor, UStaticMesh* Mesh, TArray<UMaterialInterface*>& Materials)
+{
+	if (!UserSpline || !GenMeshSpline) return;
+	if (!IsSplinePointInRange(UserSpline, UserSegment)) return;
+	if (UserSegment >= PointIndex.Num()) return;
+	UpdateSplineMeshRange(GenMeshSpline, PointIndex.GetStartPoint(UserSegment), PointIndex.GetStartPoint(GetNextSplinePoint(UserSpline, UserSegment)), Shift, SplineMeshes, Actor, Mesh, Materials);
+}
+
 /*
 
 SplinePointMap: indices: spline point ID's on user spline. values: starting spline point ID's on mesh spline per user spline point.
@@ -591,16 +689,32 @@ void USplineGenBPLibrary::ClearAll(USplineComponent* GenRefSpline, USplineCompon
 	if (GenRefSpline) GenRefSpline->ClearSplinePoints();
 	if (GenMeshSpline) GenMeshSpline->ClearSplinePoints();
 
-	USplineMeshComponent* CurrentComponent = Actor->GetComponentByClass<USplineMeshComponent>();
-	while (CurrentComponent)
+	// Gather every spline mesh once instead of re-querying the actor after each destroy, plus any tracked meshes it doesn't own.
+	TArray<USplineMeshComponent*> ToDestroy;
+	if (Actor) Actor->GetComponents(ToDestroy);
+	TSet<USplineMeshComponent*> Gathered(ToDestroy);
+	for (USplineMeshComponent* SplineMesh : SplineMeshes)
 	{
-		CurrentComponent->DestroyComponent();
-		CurrentComponent = Actor->GetComponentByClass<USplineMeshComponent>();
+		if (SplineMesh && !Gathered.Contains(SplineMesh)) ToDestroy.Add(SplineMesh);
 	}
+	DestroySplineMeshes(ToDestroy);
 
 	SplinePointMap.Empty();
 	SegmentCountMap.Empty();
-	for (int i = 0; i < SplineMeshes.Num(); i++) if (SplineMeshes[i]) SplineMeshes[i]->DestroyComponent(false);
+	SplineMeshes.Empty();
+}
+
+void USplineGenBPLibrary::DestroySplineMeshes(TArray<USplineMeshComponent*>& SplineMeshes)
+{
+	// Tear down render and physics state for the whole batch before any component is destroyed.
+	for (USplineMeshComponent* SplineMesh : SplineMeshes)
+	{
+		if (IsValid(SplineMesh) && SplineMesh->IsRegistered()) SplineMesh->UnregisterComponent();
+	}
+	for (USplineMeshComponent* SplineMesh : SplineMeshes)
+	{
+		if (IsValid(SplineMesh)) SplineMesh->DestroyComponent(false);
+	}
 	SplineMeshes.Empty();
 }
 
@@ -637,6 +751,71 @@ void USplineGenBPLibrary::UpdateAll(USplineComponent* UserSpline, int UserSpline
 	
 }
 
+void USplineGenBPLibrary::UpdateStyleRegionIndexed(USplineComponent* UserSpline, int UserSegment, TArray<USplineMeshComponent*>& SplineMeshes, UStaticMesh* Mesh, TArray<UMaterialInterface*>& Materials, const FMeshSplinePointIndex& PointIndex)
+{
+	int StartMeshSplinePoint = PointIndex.GetStartPoint(UserSegment);
+	for (int i = 0; i < PointIndex.GetSegmentCount(UserSegment); i++)
+	{
+		if (SplineMeshes.IsValidIndex(StartMeshSplinePoint + i)) UpdateStyle(SplineMeshes[StartMeshSplinePoint + i], Mesh, Materials);
+	}
+}
+
+void USplineGenBPLibrary::ClearAllIndexed(USplineComponent* GenRefSpline, USplineComponent* GenMeshSpline, FMeshSplinePointIndex& PointIndex, TArray<USplineMeshComponent*>& SplineMeshes, AActor* Actor)
+{
+	TArray<int> SplinePointMap;
+	TArray<int> SegmentCountMap;
+	ClearAll(GenRefSpline, GenMeshSpline, SplinePointMap, SegmentCountMap, SplineMeshes, Actor);
+	PointIndex = FMeshSplinePointIndex();
+}
+
+void USplineGenBPLibrary::InitAllIndexed(USplineComponent* UserSpline, USplineComponent* GenRefSpline, USplineComponent* GenMeshSpline, FMeshSplinePointIndex& PointIndex, TArray<USplineMeshComponent*>& SplineMeshes, AActor* Actor, UStaticMesh* Mesh, TArray<UMaterialInterface*>& Materials, float RefSplineOffset, float TargetMeshSegmentLength, const TArray<FRollConfig>& RollConfigs)
+{
+	ClearAllIndexed(GenRefSpline, GenMeshSpline, PointIndex, SplineMeshes, Actor);
+	InitMeshSplineIndexed(UserSpline, GenRefSpline, GenMeshSpline, PointIndex, TargetMeshSegmentLength, RollConfigs);
+	InitSplineMesh(GenMeshSpline, Mesh, Materials, SplineMeshes, Actor);
+}
+
+void USplineGenBPLibrary::UpdateAllIndexed(USplineComponent* UserSpline, int UserSplinePoint, USplineComponent* GenRefSpline, USplineComponent* GenMeshSpline, FMeshSplinePointIndex& PointIndex, TArray<USplineMeshComponent*>& SplineMeshes, AActor* Actor, UStaticMesh* Mesh, TArray<UMaterialInterface*>& Materials, float RefSplineOffset, float TargetMeshSegmentLength, const TArray<FRollConfig>& RollConfigs)
+{
+	int PreviousPoint = GetPreviousSplinePoint(UserSpline, UserSplinePoint);
+	int CurrentShift = SetMeshSplineRegionFromUserSplineSegmentIndexed(UserSpline, GenRefSpline, GenMeshSpline, PreviousPoint, PointIndex, TargetMeshSegmentLength, RollConfigs);
+	UpdateSplineMeshRegionIndexed(UserSpline, GenMeshSpline, PreviousPoint, CurrentShift, PointIndex, SplineMeshes, Actor, Mesh, Materials);
+	CurrentShift = SetMeshSplineRegionFromUserSplineSegmentIndexed(UserSpline, GenRefSpline, GenMeshSpline, UserSplinePoint, PointIndex, TargetMeshSegmentLength, RollConfigs);
+	UpdateSplineMeshRegionIndexed(UserSpline, GenMeshSpline, UserSplinePoint, CurrentShift, PointIndex, SplineMeshes, Actor, Mesh, Materials);
+}
+
+FMeshSplinePointIndex USplineGenBPLibrary::MakeMeshSplinePointIndex(const TArray<int>& SegmentCountMap)
+{
+	FMeshSplinePointIndex PointIndex;
+	PointIndex.Reset(SegmentCountMap);
+	return PointIndex;
+}
+
+void USplineGenBPLibrary::BreakMeshSplinePointIndex(const FMeshSplinePointIndex& PointIndex, TArray<int>& SplinePointMap, TArray<int>& SegmentCountMap)
+{
+	PointIndex.ToMaps(SplinePointMap, SegmentCountMap);
+}
+
+int USplineGenBPLibrary::GetMeshSplineStartingPointFromIndex(const FMeshSplinePointIndex& PointIndex, const int UserSplinePoint)
+{
+	return PointIndex.GetStartPoint(UserSplinePoint);
+}
+
+int USplineGenBPLibrary::GetMeshSplineSegmentCountFromIndex(const FMeshSplinePointIndex& PointIndex, const int UserSegment)
+{
+	return PointIndex.GetSegmentCount(UserSegment);
+}
+
+int USplineGenBPLibrary::GetUserSegmentFromMeshSplinePoint(const FMeshSplinePointIndex& PointIndex, const int MeshSplinePoint)
+{
+	return PointIndex.FindSegmentFromPoint(MeshSplinePoint);
+}
+
+int USplineGenBPLibrary::GetMeshSplinePointIndexNum(const FMeshSplinePointIndex& PointIndex)
+{
+	return PointIndex.Num();
+}
+
 TArray<USplineMeshComponent*> USplineGenBPLibrary::GetSplineMeshesOfRegion(int UserSegment, TArray<int>& SplinePointMap, TArray<USplineMeshComponent*>& SplineMeshes)
 {
 	TArray<USplineMeshComponent*> SplineMeshesRegion;
@@ -680,38 +859,24 @@ void USplineGenBPLibrary::SetSplineMeshesCollision(TArray<USplineMeshComponent*>
 	}
 }
 
+// The Bezier table only depends on the tangent ratios, which stay the same for every key within a segment, so keep the last one per thread.
+static const FSGBezierEase& GetRollCurveEase(const float StartTangentLength, const float EndTangentLength, const float SegmentLength)
+{
+	float StartTanVal = SegmentLength > 0.f ? StartTangentLength / SegmentLength : 0.f;
+	float EndTanVal = SegmentLength > 0.f ? EndTangentLength / SegmentLength : 1.f;
+	static thread_local FSGBezierEase CachedEase;
+	if (!CachedEase.Matches(StartTanVal, EndTanVal)) CachedEase = FSGBezierEase(StartTanVal, EndTanVal);
+	return CachedEase;
+}
+
 float USplineGenBPLibrary::GenRollCurve(float Value, float Min, float Max, const float StartTangentLength, const float EndTangentLength, const float SegmentLength)
 {
-	//float StartTanVal = FMath::Clamp((StartTangentLength / SegmentLength), 0.f, 1.f * 0.5f);
-	//float EndTanVal = FMath::Clamp((EndTangentLength / SegmentLength), 0.f, 1.f * 0.5f);
-	float StartTanVal = StartTangentLength / SegmentLength;
-	float EndTanVal = EndTangentLength / SegmentLength;
-	//Value = FMath::Clamp(Value, Min, Max);
-	//TArray<FVector2D> LookupTable;
-	float CurrentTVal = 0.f;
-	//float TValStep = Max / float(Resolution);
-	FVector2D P1 = FVector2D(0.f, 0.f);
-	FVector2D P2 = FVector2D(StartTanVal, 0.f);
-	FVector2D P3 = FVector2D(EndTanVal, 1.f);
-	FVector2D P4 = FVector2D(1.f, 1.f);
-	/*FVector2D LP1;
-	FVector2D LP2;
-	FVector2D LP3;
-	FVector2D FP1;
-	FVector2D FP2;*/
-	//for (int i = 0; i < Resolution; i++)
-	//{
-		//CurrentTVal = TValStep * float(i);
-	CurrentTVal = Value;
-	FVector2D LP1 = FMath::Lerp(P1, P2, CurrentTVal);
-	FVector2D LP2 = FMath::Lerp(P2, P3, CurrentTVal);
-	FVector2D LP3 = FMath::Lerp(P3, P4, CurrentTVal);
-	FVector2D FP1 = FMath::Lerp(LP1, LP2, CurrentTVal);
-	FVector2D FP2 = FMath::Lerp(LP2, LP3, CurrentTVal);
-	return FMath::Lerp(FP1, FP2, CurrentTVal).Y;
-		//LookupTable.Add(FMath::Lerp(FP1, FP2, CurrentTVal));
-	//}
-	//return LookupTable;
+	return GetRollCurveEase(StartTangentLength, EndTangentLength, SegmentLength).Eval(Value);
+}
+
+void USplineGenBPLibrary::GenRollCurveArray(TArray<float>& Values, const float StartTangentLength, const float EndTangentLength, const float SegmentLength)
+{
+	GetRollCurveEase(StartTangentLength, EndTangentLength, SegmentLength).EvalArray(Values);
 }
 
 float USplineGenBPLibrary::FindCorrectedRollAtDistanceAlongSpline(const USplineComponent* Spline, const float DistanceAlongSpline, const ESplineCoordinateSpace::Type CoordinateSpace)
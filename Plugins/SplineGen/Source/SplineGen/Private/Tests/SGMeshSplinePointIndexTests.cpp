@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+#include "SG_Types.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Checks every start point and the segment of every mesh point against a plain running sum of SegmentCounts.
+static bool SGCheckPointIndex(FAutomationTestBase& Test, const TCHAR* What, const FMeshSplinePointIndex& PointIndex, const TArray<int>& SegmentCounts)
+{
+	int Start = 0;
+	for (int Segment = 0; Segment < SegmentCounts.Num(); Segment++)
+	{
+		if (PointIndex.GetStartPoint(Segment) != Start)
+		{
+			Test.AddError(FString::Printf(TEXT("%s: segment %d starts at %d, expected %d."), What, Segment, PointIndex.GetStartPoint(Segment), Start));
+			return false;
+		}
+		for (int Point = Start; Point < Start + SegmentCounts[Segment]; Point++)
+		{
+			if (PointIndex.FindSegmentFromPoint(Point) != Segment)
+			{
+				Test.AddError(FString::Printf(TEXT("%s: point %d is in segment %d, expected %d."), What, Point, PointIndex.FindSegmentFromPoint(Point), Segment));
+				return false;
+			}
+		}
+		Start += SegmentCounts[Segment];
+	}
+	return Test.TestEqual(FString::Printf(TEXT("%s: total"), What), PointIndex.GetStartPoint(SegmentCounts.Num()), Start);
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGMeshSplinePointIndexTest, "SplineGen.MeshSplinePointIndex", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSGMeshSplinePointIndexTest::RunTest(const FString& Parameters)
+{
+	TArray<int> SegmentCounts = { 3, 1, 4, 1, 5, 9, 2, 6, 5, 3, 5 };
+	FMeshSplinePointIndex PointIndex;
+	PointIndex.Reset(SegmentCounts);
+	if (!SGCheckPointIndex(*this, TEXT("Reset"), PointIndex, SegmentCounts)) return false;
+
+	SegmentCounts[4] = 8;
+	PointIndex.SetSegmentCount(4, 8);
+	if (!SGCheckPointIndex(*this, TEXT("SetSegmentCount"), PointIndex, SegmentCounts)) return false;
+
+	SegmentCounts.Add(7);
+	PointIndex.AddSegment(7);
+	if (!SGCheckPointIndex(*this, TEXT("AddSegment"), PointIndex, SegmentCounts)) return false;
+
+	// Resetting a populated index, as InitMeshSplineIndexed does on every rebuild, must not build on the old tree. Same size, then smaller, then larger.
+	const TArray<int> SameSize = { 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2 };
+	PointIndex.Reset(SameSize);
+	if (!SGCheckPointIndex(*this, TEXT("Reset to the same size"), PointIndex, SameSize)) return false;
+
+	const TArray<int> Smaller = { 4, 6, 1 };
+	PointIndex.Reset(Smaller);
+	if (!SGCheckPointIndex(*this, TEXT("Reset smaller"), PointIndex, Smaller)) return false;
+
+	const TArray<int> Larger = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17 };
+	PointIndex.Reset(Larger);
+	if (!SGCheckPointIndex(*this, TEXT("Reset larger"), PointIndex, Larger)) return false;
+
+	PointIndex.Reset(TArray<int>());
+	TestEqual(TEXT("Reset empty"), PointIndex.Num(), 0);
+	TestEqual(TEXT("Reset empty finds no segment"), PointIndex.FindSegmentFromPoint(0), -1);
+	return true;
+}
+
+#endif
@@ -0,0 +1,162 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Misc/AutomationTest.h"
+#include "SGMeshSplineComponent.h"
+#include "SplineGenBPLibrary.h"
+#include <limits>
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+// Byte offsets into a version 1 track: the magic and version, then Flags, UpVectorMode, TargetMeshLength, LocalOffset and the Locations count.
+static const int32 SGTestTargetMeshLengthOffset = 13;
+static const int32 SGTestLocationsCountOffset = 25;
+
+// A rolling, climbing track with every format field set to something other than its default.
+static USGMeshSplineComponent* SGMakeTestTrack(int NumPoints)
+{
+	USGMeshSplineComponent* Spline = NewObject<USGMeshSplineComponent>(GetTransientPackage());
+	TArray<FSplinePointSetting> Points;
+	Points.SetNum(NumPoints);
+	for (int i = 0; i < NumPoints; i++)
+	{
+		// Float values throughout, so nothing is lost to the format's floats and a resave can match byte for byte.
+		const float Angle = i * 0.1f;
+		Points[i].LocationCoordSpace = ESplineCoordinateSpace::Local;
+		Points[i].Location = FVector(FVector3f(i * 400.f, FMath::Sin(Angle) * 2000.f, i * 15.f));
+		Points[i].UpVectorCoordSpace = ESplineCoordinateSpace::Local;
+		Points[i].UpVector = FVector(FVector3f(0.f, FMath::Sin(Angle * 0.5f), FMath::Cos(Angle * 0.5f)));
+		Points[i].TangentCoordSpace = ESplineCoordinateSpace::Local;
+		Points[i].Tangent = FVector(FVector3f(400.f, FMath::Cos(Angle) * 200.f, 15.f));
+		Points[i].Scale = FVector(1.0, 1.0 + (i % 3) * 0.25, 1.0);
+	}
+	USplineGenBPLibrary::SetSplinePoints(Spline, 0, Points, false);
+	Spline->UpVectorMode = ESGUpVectorMode::EasedRoll;
+	Spline->TargetMeshLength = 250.f;
+	Spline->LocalOffset = FVector2D(20.0, -10.0);
+	Spline->bEnableLocalOffset = true;
+	Spline->SegmentRollConfigs.Init(FRollConfig(EInterpInOutType::Sine, EInterpInOutSelection::EaseIn, 2.f), FMath::Max(NumPoints - 1, 0));
+	Spline->SplineCurveRoll.AddPoint(0.f, 0.5f);
+	Spline->SplineCurveRoll.AddPoint(float(NumPoints - 1), -0.5f);
+	Spline->RollChannelLoopTwist = 0.25f;
+	Spline->SetClosedLoop(true, false);
+	Spline->UpdateSpline();
+	return Spline;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGTrackFormatRoundTripTest, "SplineGen.TrackFormat.RoundTrip", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSGTrackFormatRoundTripTest::RunTest(const FString& Parameters)
+{
+	USGMeshSplineComponent* Source = SGMakeTestTrack(64);
+	TArray<uint8> Bytes;
+	Source->SaveTrackToBytes(Bytes);
+
+	USGMeshSplineComponent* Loaded = NewObject<USGMeshSplineComponent>(GetTransientPackage());
+	if (!TestTrue(TEXT("Load succeeds"), Loaded->LoadTrackFromBytes(Bytes, false))) return false;
+
+	TestEqual(TEXT("Point count"), Loaded->GetNumberOfSplinePoints(), Source->GetNumberOfSplinePoints());
+	TestTrue(TEXT("Closed loop"), Loaded->IsClosedLoop() == Source->IsClosedLoop());
+	TestEqual(TEXT("Up vector mode"), int(Loaded->UpVectorMode), int(Source->UpVectorMode));
+	TestEqual(TEXT("Target mesh length"), Loaded->TargetMeshLength, Source->TargetMeshLength);
+	TestTrue(TEXT("Local offset"), Loaded->LocalOffset.Equals(Source->LocalOffset));
+	TestTrue(TEXT("Local offset enabled"), Loaded->bEnableLocalOffset == Source->bEnableLocalOffset);
+	TestEqual(TEXT("Roll config count"), Loaded->SegmentRollConfigs.Num(), Source->SegmentRollConfigs.Num());
+	TestEqual(TEXT("Roll channel points"), Loaded->SplineCurveRoll.Points.Num(), Source->SplineCurveRoll.Points.Num());
+	TestEqual(TEXT("Roll channel loop twist"), Loaded->RollChannelLoopTwist, Source->RollChannelLoopTwist);
+
+	// The format stores floats, so compare within float precision of the source's doubles.
+	for (int i = 0; i < Source->GetNumberOfSplinePoints(); i++)
+	{
+		const FInterpCurvePoint<FVector>& Expected = Source->SplineCurves.Position.Points[i];
+		const FInterpCurvePoint<FVector>& Actual = Loaded->SplineCurves.Position.Points[i];
+		if (!Actual.OutVal.Equals(Expected.OutVal, 0.01) || !Actual.ArriveTangent.Equals(Expected.ArriveTangent, 0.01) || !Actual.LeaveTangent.Equals(Expected.LeaveTangent, 0.01) || Actual.InterpMode != Expected.InterpMode)
+		{
+			AddError(FString::Printf(TEXT("Position point %d differs after loading."), i));
+			return false;
+		}
+		if (!Loaded->SplineCurves.Rotation.Points[i].OutVal.Equals(Source->SplineCurves.Rotation.Points[i].OutVal, 1e-5) || !Loaded->SplineCurves.Scale.Points[i].OutVal.Equals(Source->SplineCurves.Scale.Points[i].OutVal, 1e-5))
+		{
+			AddError(FString::Printf(TEXT("Rotation or scale of point %d differs after loading."), i));
+			return false;
+		}
+	}
+
+	// Everything the format holds came back, so saving again writes the same bytes.
+	TArray<uint8> ResavedBytes;
+	Loaded->SaveTrackToBytes(ResavedBytes);
+	TestTrue(TEXT("Resaved bytes match"), ResavedBytes == Bytes);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGTrackFormatRejectsBadDataTest, "SplineGen.TrackFormat.RejectsBadData", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FSGTrackFormatRejectsBadDataTest::RunTest(const FString& Parameters)
+{
+	TArray<uint8> Bytes;
+	SGMakeTestTrack(32)->SaveTrackToBytes(Bytes);
+	USGMeshSplineComponent* Target = SGMakeTestTrack(5);
+
+	// Every failed load must leave Target's five points alone.
+	auto ExpectRejected = [this, Target](const TCHAR* What, const TArray<uint8>& BadBytes)
+	{
+		TestFalse(What, Target->LoadTrackFromBytes(BadBytes, false));
+		TestEqual(FString::Printf(TEXT("%s leaves the track unchanged"), What), Target->GetNumberOfSplinePoints(), 5);
+	};
+
+	ExpectRejected(TEXT("Empty file"), TArray<uint8>());
+
+	TArray<uint8> BadMagic = Bytes;
+	BadMagic[0] ^= 0xFF;
+	ExpectRejected(TEXT("Wrong magic"), BadMagic);
+
+	for (int32 Length : { 4, 8, SGTestLocationsCountOffset, SGTestLocationsCountOffset + 100, Bytes.Num() / 2, Bytes.Num() - 1 })
+	{
+		ExpectRejected(*FString::Printf(TEXT("Truncated to %d bytes"), Length), TArray<uint8>(Bytes.GetData(), Length));
+	}
+
+	TArray<uint8> HugeCount = Bytes;
+	const int32 Count = MAX_int32;
+	FMemory::Memcpy(HugeCount.GetData() + SGTestLocationsCountOffset, &Count, sizeof(Count));
+	ExpectRejected(TEXT("Point count larger than the file"), HugeCount);
+
+	for (float MeshLength : { 0.f, -100.f, std::numeric_limits<float>::infinity(), FMath::Sqrt(-1.f) })
+	{
+		TArray<uint8> BadMeshLength = Bytes;
+		FMemory::Memcpy(BadMeshLength.GetData() + SGTestTargetMeshLengthOffset, &MeshLength, sizeof(MeshLength));
+		ExpectRejected(*FString::Printf(TEXT("Target mesh length %f"), MeshLength), BadMeshLength);
+	}
+
+	TArray<uint8> NaNLocation = Bytes;
+	const float NaN = FMath::Sqrt(-1.f);
+	FMemory::Memcpy(NaNLocation.GetData() + SGTestLocationsCountOffset + sizeof(int32), &NaN, sizeof(NaN));
+	ExpectRejected(TEXT("Non-finite location"), NaNLocation);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FSGTrackFormatLoadBenchmarkTest, "SplineGen.TrackFormat.LoadBenchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FSGTrackFormatLoadBenchmarkTest::RunTest(const FString& Parameters)
+{
+	const int NumPoints = 10000;
+	const int NumLoads = 10;
+	TArray<uint8> Bytes;
+	SGMakeTestTrack(NumPoints)->SaveTrackToBytes(Bytes);
+
+	// Time the load alone: parse, validate, fill the curves and the one spline update. Derived data stays lazy, as it does for a real load.
+	USGMeshSplineComponent* Target = NewObject<USGMeshSplineComponent>(GetTransientPackage());
+	double BestSeconds = TNumericLimits<double>::Max();
+	double TotalSeconds = 0.0;
+	for (int i = 0; i < NumLoads; i++)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		if (!TestTrue(TEXT("Load succeeds"), Target->LoadTrackFromBytes(Bytes, false))) return false;
+		const double Seconds = FPlatformTime::Seconds() - StartTime;
+		BestSeconds = FMath::Min(BestSeconds, Seconds);
+		TotalSeconds += Seconds;
+	}
+	TestEqual(TEXT("Point count"), Target->GetNumberOfSplinePoints(), NumPoints);
+	AddInfo(FString::Printf(TEXT("Loaded %d points (%d bytes): best %.2f ms, mean %.2f ms over %d loads."), NumPoints, Bytes.Num(), BestSeconds * 1000.0, TotalSeconds * 1000.0 / NumLoads, NumLoads));
+	return true;
+}
+
+#endif
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SG_Types.h"
+
+// Streaming import of dense track exports from coaster design tools: one row per point with PosX/Y/Z, FrontX/Y/Z, LeftX/Y/Z and UpX/Y/Z columns, as in the S_CSVData sample struct.
+// Columns are found by header name in any order, so index columns and extra columns are skipped. Comma, tab and semicolon delimiters are recognised from the header.
+namespace SGCSVImport
+{
+	// Reads Filename in chunks into OutPoints, in local space with tangents sized to the neighbouring points. Positions are multiplied by PositionScale, and Y and Z are swapped
+	// if bConvertFromYUp, which also turns right-handed exports left-handed. Returns false with OutError describing the first bad header or row.
+	SPLINEGEN_API bool ReadTrackFile(const FString& Filename, float PositionScale, bool bConvertFromYUp, bool bClosedLoop, TArray<FSplinePointSetting>& OutPoints, FString& OutError);
+}
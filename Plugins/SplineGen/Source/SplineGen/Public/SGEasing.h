@@ -0,0 +1,95 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SG_Types.h"
+
+// Easing kernels in their 0..1 form. They match FMath::Interp*(0.f, 1.f, Alpha) exactly, so Lerp(A, B, Kernel(Alpha)) gives the same result as the FMath helper.
+namespace SGEasing
+{
+	struct FLinear { float Exp; FORCEINLINE float operator()(float Alpha) const { return Alpha; } };
+	struct FCircularIn { float Exp; FORCEINLINE float operator()(float Alpha) const { return FMath::InterpCircularIn(0.f, 1.f, Alpha); } };
+	struct FCircularOut { float Exp; FORCEINLINE float operator()(float Alpha) const { return FMath::InterpCircularOut(0.f, 1.f, Alpha); } };
+	struct FCircularInOut { float Exp; FORCEINLINE float operator()(float Alpha) const { return FMath::InterpCircularInOut(0.f, 1.f, Alpha); } };
+	struct FEaseIn { float Exp; FORCEINLINE float operator()(float Alpha) const { return FMath::InterpEaseIn(0.f, 1.f, Alpha, Exp); } };
+	struct FEaseOut { float Exp; FORCEINLINE float operator()(float Alpha) const { return FMath::InterpEaseOut(0.f, 1.f, Alpha, Exp); } };
+	struct FEaseInOut { float Exp; FORCEINLINE float operator()(float Alpha) const { return FMath::InterpEaseInOut(0.f, 1.f, Alpha, Exp); } };
+	struct FExpoIn { float Exp; FORCEINLINE float operator()(float Alpha) const { return FMath::InterpExpoIn(0.f, 1.f, Alpha); } };
+	struct FExpoOut { float Exp; FORCEINLINE float operator()(float Alpha) const { return FMath::InterpExpoOut(0.f, 1.f, Alpha); } };
+	struct FExpoInOut { float Exp; FORCEINLINE float operator()(float Alpha) const { return FMath::InterpExpoInOut(0.f, 1.f, Alpha); } };
+	struct FSinIn { float Exp; FORCEINLINE float operator()(float Alpha) const { return FMath::InterpSinIn(0.f, 1.f, Alpha); } };
+	struct FSinOut { float Exp; FORCEINLINE float operator()(float Alpha) const { return FMath::InterpSinOut(0.f, 1.f, Alpha); } };
+	struct FSinInOut { float Exp; FORCEINLINE float operator()(float Alpha) const { return FMath::InterpSinInOut(0.f, 1.f, Alpha); } };
+}
+
+// An FRollConfig resolved once into a single easing kernel. Eval and EvalArray then run that kernel with no switching per sample.
+struct SPLINEGEN_API FSGEasing
+{
+	FSGEasing() = default;
+
+	explicit FSGEasing(const FRollConfig& RollConfig);
+
+	FORCEINLINE float Eval(float Alpha) const { return EvalFn(Alpha, Exp); }
+
+	// Eases every alpha in place.
+	FORCEINLINE void EvalArray(TArrayView<float> Alphas) const { EvalArrayFn(Alphas.GetData(), Alphas.Num(), Exp); }
+
+	// True if Eval returns Alpha unchanged (Linear or no in/out selection).
+	bool IsLinear() const { return bLinear; }
+
+private:
+	template<typename KernelT>
+	static float EvalKernel(float Alpha, float Exp)
+	{
+		return KernelT{ Exp }(Alpha);
+	}
+
+	template<typename KernelT>
+	static void EvalKernelArray(float* Alphas, int Num, float Exp)
+	{
+		const KernelT Kernel{ Exp };
+		for (int i = 0; i < Num; i++) Alphas[i] = Kernel(Alphas[i]);
+	}
+
+	template<typename KernelT>
+	void Bind()
+	{
+		EvalFn = &EvalKernel<KernelT>;
+		EvalArrayFn = &EvalKernelArray<KernelT>;
+	}
+
+	float (*EvalFn)(float, float) = &EvalKernel<SGEasing::FLinear>;
+	void (*EvalArrayFn)(float*, int, float) = &EvalKernelArray<SGEasing::FLinear>;
+	float Exp = 1.f;
+	bool bLinear = true;
+};
+
+// Ease curve shaped as a 2D cubic Bezier from (0,0) to (1,1) with control points (StartX, 0) and (EndX, 1).
+// Eval solves X(t) = Alpha for t and returns Y(t). A small table of X(t) gives the first guess, and Newton steps refine it.
+// Control X values are clamped to [0,1], which keeps X(t) monotonic so every alpha has exactly one t.
+struct SPLINEGEN_API FSGBezierEase
+{
+	static constexpr int TableSize = 17;
+
+	FSGBezierEase() : FSGBezierEase(0.f, 1.f) {}
+
+	FSGBezierEase(float InStartX, float InEndX);
+
+	float Eval(float Alpha) const;
+
+	void EvalArray(TArrayView<float> Alphas) const;
+
+	bool Matches(float InStartX, float InEndX) const { return StartX == FMath::Clamp(InStartX, 0.f, 1.f) && EndX == FMath::Clamp(InEndX, 0.f, 1.f); }
+
+private:
+	float SolveT(float Alpha) const;
+
+	float StartX = 0.f;
+	float EndX = 1.f;
+
+	// Power-basis coefficients of X(t) = ((AX * t + BX) * t + CX) * t, and the same for Y.
+	float AX = 0.f, BX = 0.f, CX = 0.f;
+	float AY = 0.f, BY = 0.f, CY = 0.f;
+
+	// X(t) sampled at t = i / (TableSize - 1).
+	float XTable[TableSize];
+};
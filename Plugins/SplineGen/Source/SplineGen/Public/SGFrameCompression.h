@@ -0,0 +1,69 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/Float16.h"
+
+struct FSGFrameTable;
+
+// Octahedral mapping between unit vectors and [-1,1] squared.
+namespace SGOctahedral
+{
+	SPLINEGEN_API FVector2f Encode(const FVector3f& Normal);
+
+	// Decodes Num coordinate pairs into unit vectors, four lanes at a time with a scalar tail.
+	SPLINEGEN_API void DecodeArray(const float* U, const float* V, float* OutX, float* OutY, float* OutZ, int Num);
+}
+
+// Compressed baked frames as structure of arrays. Each sample stores forward and up as 16-bit octahedral pairs, its position as 16 bits per axis inside its chunk's bounds,
+// and its scale as half floats: 20 bytes, plus 36 bytes per chunk. Chunks match the FSGFrameTable it was encoded from.
+struct SPLINEGEN_API FSGCompressedFrameTable
+{
+	int SamplesPerChunk = 0;
+
+	TArray<FVector> ChunkMins;
+
+	// Chunk bounds extent over 65535, so an axis decodes to Min + Quantised * Step.
+	TArray<FVector3f> ChunkSteps;
+
+	TArray<uint16> PositionX;
+	TArray<uint16> PositionY;
+	TArray<uint16> PositionZ;
+
+	TArray<uint16> ForwardU;
+	TArray<uint16> ForwardV;
+	TArray<uint16> UpU;
+	TArray<uint16> UpV;
+
+	TArray<FFloat16> ScaleX;
+	TArray<FFloat16> ScaleY;
+	TArray<FFloat16> ScaleZ;
+
+	int Num() const { return ForwardU.Num(); }
+
+	int GetChunk(int Sample) const { return FMath::Min(Sample / SamplesPerChunk, ChunkMins.Num() - 1); }
+
+	void Reset();
+
+	// Compresses Frames. Scales holds one scale per frame sample.
+	void Encode(const FSGFrameTable& Frames, TArrayView<const FVector> Scales);
+
+	FVector GetPosition(int Sample) const;
+
+	FVector GetScale(int Sample) const { return FVector(ScaleX[Sample].GetFloat(), ScaleY[Sample].GetFloat(), ScaleZ[Sample].GetFloat()); }
+
+	// Decoded forward and up vectors of Count samples from First, through the SIMD decoder.
+	void DecodeAxes(int First, int Count, TArray<FVector3f>& OutForwards, TArray<FVector3f>& OutUps) const;
+
+	// Rotation interpolated at a fractional sample index.
+	FQuat SampleRotation(float Sample) const;
+
+	// Same as FSGFrameTable::SampleTransforms. The axes of each block of queries are gathered and decoded together before the transforms are built.
+	void SampleTransforms(TArrayView<const float> Samples, const FTransform& ToOutput, TArrayView<FTransform> OutTransforms) const;
+
+	// Largest position error the quantisation allows: half a step on every axis of the coarsest chunk.
+	float GetPositionErrorBound() const;
+
+	SIZE_T GetAllocatedSize() const;
+
+	void Serialize(FArchive& Ar);
+};
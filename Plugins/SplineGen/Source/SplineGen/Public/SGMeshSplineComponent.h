@@ -60,6 +60,47 @@ struct FSectionDivisions
 	{}
 };
 
+// Uniform grid over local space control point locations, stored as cell ranges into one sorted index array.
+struct FSGControlPointGrid
+{
+	FVector Origin = FVector::ZeroVector;
+	double CellSize = 1.0;
+	FIntVector Dims = FIntVector(0);
+	TArray<int32> CellStarts;
+	TArray<int32> PointIndices;
+	TArray<FVector> Points;
+
+	void Build(const FInterpCurveVector& Position);
+	int32 Num() const { return Points.Num(); }
+
+	FIntVector GetCellCoord(const FVector& LocalLocation) const;
+	void GetCellBox(const FIntVector& Cell, FBox& OutBox) const;
+
+	// Calls Visitor once per non-empty cell overlapping LocalBox, with the point indices in that cell.
+	void ForEachCellInBox(const FBox& LocalBox, TFunctionRef<void(const FIntVector&, TArrayView<const int32>)> Visitor) const;
+
+	// Calls Visitor once per non-empty cell that may overlap the convex region where X * x + Y * y + Z * z + W >= 0 for every plane, in local space.
+	// Blocks of cells are tested as a whole and halved until they are inside, outside or one cell, so cells away from the region are never looked at.
+	void ForEachCellInRegion(TConstArrayView<FVector4> Planes, TFunctionRef<void(const FIntVector&, TArrayView<const int32>)> Visitor) const;
+
+private:
+	void VisitRegionBlock(const FIntVector& MinCell, const FIntVector& MaxCell, TConstArrayView<FVector4> Planes, TFunctionRef<void(const FIntVector&, TArrayView<const int32>)> Visitor) const;
+	void VisitCells(const FIntVector& MinCell, const FIntVector& MaxCell, TFunctionRef<void(const FIntVector&, TArrayView<const int32>)> Visitor) const;
+};
+
+// Everything UpdateSection sets on one spline mesh, in local space. Written as is to the track cache, so it stays plain floats.
+struct FSGMeshPieceRecord
+{
+	FVector3f StartLocation;
+	FVector3f StartTangent;
+	FVector3f EndLocation;
+	FVector3f EndTangent;
+	FVector3f UpDir;
+	FVector2f StartScale;
+	FVector2f EndScale;
+	float EndRoll;
+};
+
 /**
  * 
  */
@@ -85,6 +126,29 @@ private:
 	TArray<int> CurrentSelection = {};
 
 	TArray<FSplineMeshSection> AllMeshes;
+
+	FSGControlPointGrid ControlPointGrid;
+
+	uint32 ControlPointGridRevision = 0;
+
+	void UpdateControlPointGrid();
+
+	void MergeIntoCurrentSelection(const TArray<int>& Points);
+
+	// Compute stage of UpdateSection: the piece records of a valid section, from the spline alone.
+	void ComputeSectionPieces(int SplinePoint, TArray<FSGMeshPieceRecord>& OutPieces);
+
+	// Apply stage of UpdateSection: spawns, updates and despawns the section's spline meshes to match Pieces.
+	void ApplySectionPieces(int SplinePoint, FSectionStyle Style, TArrayView<const FSGMeshPieceRecord> Pieces);
+
+	// Track cache key: the derived data hash, the cache format version and the component scale, which the piece rolls depend on.
+	FSHAHash ComputeTrackCacheKey() const;
+
+	// Adopts the derived data and applies the pieces of a valid cache file for Key. Returns false, having changed nothing, on a miss or an invalid file.
+	bool LoadTrackCache(const FSHAHash& Key, const TArray<FSectionStyle>& Styles);
+
+	// Writes the derived data and SectionPieces for Key, then trims the cache directory to MaxTrackCacheSizeMB.
+	void SaveTrackCache(const FSHAHash& Key, const TArray<TArray<FSGMeshPieceRecord>>& SectionPieces);
 	
 	UPROPERTY(EditAnywhere)
 	FSectionStyle DefaultStyle = FSectionStyle();
@@ -102,13 +166,49 @@ public:
 	UFUNCTION(BlueprintPure, meta = (Keywords = ""), Category = "")
 	FVector2D MapScaleTo2D(FVector Scale);
 
+	// Distances go through GetCorrectInputKeyAtDistanceAlongSpline, so they follow ArcLengthMode.
 	UFUNCTION(BlueprintPure, meta = (Keywords = ""), Category = "")
 	float FindDeltaRollAtDistanceAlongSpline(float StartDist, float EndDist, FVector OverrideTangentNext = FVector::ZeroVector);
 
-	// After loading a park/coaster.
+	UFUNCTION(BlueprintPure, meta = (Keywords = ""), Category = "")
+	float FindDeltaRollAtSplineInputKey(float StartKey, float EndKey, FVector OverrideTangentNext = FVector::ZeroVector);
+
+	// After loading a park/coaster. With bUseTrackCache, an unchanged track applies its cached mesh pieces instead of deriving them.
 	UFUNCTION(BlueprintCallable, meta = (Keywords = ""), Category = "")
 	void UpdateAll(TArray<FSectionStyle> Styles, bool bUpdateTransforms = true);
 
+	// Keep a cache file per track under Saved/SplineGen/TrackCache, so UpdateAll on an unchanged track skips deriving frames and mesh pieces and only applies them.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	bool bUseTrackCache = false;
+
+	// Tracks whose cache file would be larger than this aren't cached.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ClampMin=1, ClampMax=2047, EditCondition="bUseTrackCache"))
+	int MaxTrackCacheFileSizeMB = 64;
+
+	// Least recently used cache files are deleted once the directory grows past this.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ClampMin=1, EditCondition="bUseTrackCache"))
+	int MaxTrackCacheSizeMB = 512;
+
+	// Deletes every track cache file.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "Track Cache"), Category = "")
+	static void ClearTrackCache();
+
+	// Writes the track to the compact binary track format: control points, section styles, roll configs, local offset and TargetMeshLength.
+	// Styles are stored once each as asset paths, with one palette index per section.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "Save Track Binary"), Category = "")
+	void SaveTrackToBytes(TArray<uint8>& OutBytes);
+
+	// Replaces the track with one written by SaveTrackToBytes. Fills the curves in one go and updates the spline once, then updates every section if bUpdateSections.
+	// Returns false and leaves the track unchanged if Bytes isn't a track of a version this build reads.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "Load Track Binary"), Category = "")
+	bool LoadTrackFromBytes(const TArray<uint8>& Bytes, bool bUpdateSections = true);
+
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "Save Track Binary"), Category = "")
+	bool SaveTrackToFile(const FString& Filename);
+
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "Load Track Binary"), Category = "")
+	bool LoadTrackFromFile(const FString& Filename, bool bUpdateSections = true);
+
 	UFUNCTION(BlueprintCallable, meta = (Keywords = ""), Category = "")
 	void UpdateSelection(TArray<int> Selection, FSectionStyle Style = FSectionStyle(), bool bUpdateTransforms = true);
 
@@ -118,6 +218,14 @@ public:
 	UFUNCTION(BlueprintCallable, meta = (Keywords = ""), Category = "")
 	void SetCurrentSelection(TArray<int> NewSelection);
 	
+	// Marquee/volume selection. Returns sorted control point indices inside WorldBox, ready for SetCurrentSelection.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "Box Marquee Select"), Category = "")
+	TArray<int> GetSplinePointsInBox(FBox WorldBox, bool bMergeIntoCurrentSelection = false);
+
+	// Lasso selection. ScreenPolygon is in viewport pixels, projected the same way as FSceneView::ProjectWorldToScreen.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "Lasso Marquee Select"), Category = "")
+	TArray<int> GetSplinePointsInScreenPolygon(const TArray<FVector2D>& ScreenPolygon, FMatrix ViewProjectionMatrix, FVector2D ViewportSize, bool bMergeIntoCurrentSelection = false);
+
 	// User selects a control point to edit.
 	UFUNCTION(BlueprintCallable, meta = (Keywords = ""), Category = "")
 	void AddToSelection(int Point);
@@ -137,6 +245,12 @@ public:
 	UFUNCTION(BlueprintCallable, meta = (Keywords = ""), Category = "")
 	void SetStyleOnSelected(FSectionStyle Style);
 
+	// User moves, rotates or scales the selected control points about Pivot. Writes every selected point directly, then updates the spline and the affected sections once.
+	// The spline update and the derived data rebuild cover the whole track, only the section rebuild is limited to the affected segments.
+	// Pass bUpdateSections = false while an edit operation is ticking, since the tick already rebuilds the selection.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = ""), Category = "")
+	void ApplyTransformToSelection(FTransform Delta, FVector Pivot, ESplineCoordinateSpace::Type CoordinateSpace, bool bUpdateSections = true);
+
 	// User holds mouse button down to perform an edit. 
 	UFUNCTION(BlueprintCallable, meta = (Keywords = ""), Category = "")
 	void StartSelectionEditOperation();
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "SGSplineComponent.h"
+#include "SGPointGizmoComponent.generated.h"
+
+/**
+ * Draws one gizmo per control point of Spline through a single instanced static mesh, and picks points analytically instead of through collision.
+ * Per-instance custom data 0 is 0 for idle points, 1 for the hovered point and 2 for selected points, for use in the gizmo material.
+ */
+UCLASS(Meta = (BlueprintSpawnableComponent))
+class SPLINEGEN_API USGPointGizmoComponent : public UInstancedStaticMeshComponent
+{
+	GENERATED_BODY()
+
+public:
+	USGPointGizmoComponent();
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	USGSplineComponent* Spline = nullptr;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	float GizmoScale = 1.f;
+
+	// World space radius of each point for picking, multiplied by GizmoScale.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	float PickRadius = 50.f;
+
+private:
+	struct FPointState
+	{
+		FVector Location;
+		FQuat Frame;
+	};
+
+	// Control point locations and corrected frames as of the last SyncToSpline, in the spline's local space.
+	TArray<FPointState> CachedPoints;
+
+	FTransform CachedSplineToGizmo = FTransform::Identity;
+
+	int HoveredPoint = -1;
+
+	TArray<int> SelectedPoints;
+
+	float GetPointState(int Point) const;
+
+	void SetPointState(int Point, bool bMarkRenderStateDirty);
+
+public:
+	// Adds/removes instances to match the spline and moves only the instances whose location or corrected frame changed. Call after editing the spline.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = ""), Category = "")
+	void SyncToSpline(bool bForceAll = false);
+
+	// Index of the nearest control point whose pick sphere is hit by the world space ray, or -1.
+	UFUNCTION(BlueprintPure, meta = (Keywords = "Hover Click"), Category = "")
+	int PickPoint(FVector RayOrigin, FVector RayDirection, float MaxDistance = 100000.f) const;
+
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "Hover"), Category = "")
+	void SetHoveredPoint(int Point);
+
+	UFUNCTION(BlueprintPure, meta = (Keywords = "Hover"), Category = "")
+	int GetHoveredPoint() const;
+
+	// Usually fed from USGMeshSplineComponent::GetCurrentSelection.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = ""), Category = "")
+	void SetSelectedPoints(TArray<int> NewSelection);
+};
@@ -4,8 +4,247 @@
 
 #include "CoreMinimal.h"
 #include "Components/SplineComponent.h"
+#include "HAL/CriticalSection.h"
+#include "Misc/SecureHash.h"
+#include "SG_Types.h"
+#include "SGFrameCompression.h"
 #include "SGSplineComponent.generated.h"
 
+UENUM(BlueprintType)
+enum class ESGUpVectorMode : uint8
+{
+	HermiteCurve            UMETA(DisplayName = "Hermite Curve", Tooltip = "Interpolate SplineCurveUpVector per query."),
+	EasedRoll               UMETA(DisplayName = "Eased Roll", Tooltip = "Roll relative to a transported reference frame, eased per segment by SegmentRollConfigs and baked into the frame table."),
+	RollChannel             UMETA(DisplayName = "Roll Channel", Tooltip = "Roll relative to a transported reference frame, interpolated from SplineCurveRoll and baked into the frame table."),
+	NoRoll                  UMETA(DisplayName = "No Roll", Tooltip = "Use the rotation-minimising reference frame as is, ignoring control point rotations. Suited to racetracks.")
+};
+
+UENUM(BlueprintType)
+enum class ESGArcLengthMode : uint8
+{
+	ReparamTable            UMETA(DisplayName = "Reparam Table", Tooltip = "Map distance to input key with the spline's piecewise linear reparam table."),
+	Exact                   UMETA(DisplayName = "Exact", Tooltip = "Map distance to input key with Gauss-Legendre segment lengths and Newton inversion."),
+	AdaptiveTable           UMETA(DisplayName = "Adaptive Table", Tooltip = "Map distance to input key with a table subdivided per segment until its interpolation error is under AdaptiveReparamTolerance.")
+};
+
+USTRUCT(BlueprintType)
+struct FSGArcLengthBenchmarkResult
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int NumQueries = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float TableQueriesPerSecond = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float ExactQueriesPerSecond = 0.f;
+
+	// Distance errors of the returned keys against a high order reference, in spline length units.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float TableMeanError = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float TableMaxError = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float ExactMeanError = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float ExactMaxError = 0.f;
+
+	FSGArcLengthBenchmarkResult()
+		: NumQueries(0),
+		TableQueriesPerSecond(0.f),
+		ExactQueriesPerSecond(0.f),
+		TableMeanError(0.f),
+		TableMaxError(0.f),
+		ExactMeanError(0.f),
+		ExactMaxError(0.f)
+	{}
+};
+
+USTRUCT(BlueprintType)
+struct FSGFrameCompressionReport
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int NumSamples = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float TrackLengthMetres = 0.f;
+
+	// Float32 SoA table. Errors are in spline length units against the double precision curve at the samples.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float FloatBytesPerMetre = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float FloatPositionErrorBound = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float FloatMaxPositionError = 0.f;
+
+	// Compressed table. The angle error is the largest between decoded and float32 forward or up vectors, in degrees.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float CompressedBytesPerMetre = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float CompressedPositionErrorBound = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float CompressedMaxPositionError = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float CompressedMaxAngleError = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float CompressedMaxScaleError = 0.f;
+
+	FSGFrameCompressionReport()
+		: NumSamples(0),
+		TrackLengthMetres(0.f),
+		FloatBytesPerMetre(0.f),
+		FloatPositionErrorBound(0.f),
+		FloatMaxPositionError(0.f),
+		CompressedBytesPerMetre(0.f),
+		CompressedPositionErrorBound(0.f),
+		CompressedMaxPositionError(0.f),
+		CompressedMaxAngleError(0.f),
+		CompressedMaxScaleError(0.f)
+	{}
+};
+
+// Where a segment starts along the spline and how it splits into TargetMeshLength pieces.
+USTRUCT(BlueprintType)
+struct FSGSegmentLayout
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float StartDistance = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Length = 0.f;
+
+	// Zero only for an empty segment.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int PieceCount = 0;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float PieceLength = 0.f;
+
+	FSGSegmentLayout()
+		: StartDistance(0.f),
+		Length(0.f),
+		PieceCount(0),
+		PieceLength(0.f)
+	{}
+};
+
+// One curve segment in power basis: Value(T) = ((A * T + B) * T + C) * T + D for T in [0,1] across the segment.
+struct FSGCubicSegment
+{
+	FVector A = FVector::ZeroVector;
+	FVector B = FVector::ZeroVector;
+	FVector C = FVector::ZeroVector;
+	FVector D = FVector::ZeroVector;
+
+	// Builds the segment from P0 to P1 the same way FInterpCurve::Eval interpolates it, including linear and constant keys.
+	static FSGCubicSegment FromCurvePoints(const FInterpCurvePoint<FVector>& P0, const FInterpCurvePoint<FVector>& P1, float KeySpan);
+
+	FORCEINLINE FVector Eval(double T) const { return ((A * T + B) * T + C) * T + D; }
+	FORCEINLINE FVector EvalDerivative(double T) const { return (3.0 * A * T + 2.0 * B) * T + C; }
+};
+
+typedef TArray<FSGCubicSegment, TAlignedHeapAllocator<64>> FSGCubicSegmentArray;
+
+// Baked frames as float32 structure of arrays. Positions are stored relative to a double precision origin per chunk (one chunk per segment),
+// so they keep float precision on multi-kilometre tracks. A chunk owns SamplesPerChunk samples; the final sample belongs to the last chunk.
+struct SPLINEGEN_API FSGFrameTable
+{
+	int SamplesPerChunk = 0;
+
+	TArray<FVector> ChunkOrigins;
+
+	TArray<float> PositionX;
+	TArray<float> PositionY;
+	TArray<float> PositionZ;
+
+	TArray<float> RotationX;
+	TArray<float> RotationY;
+	TArray<float> RotationZ;
+	TArray<float> RotationW;
+
+	int Num() const { return RotationW.Num(); }
+
+	int GetChunk(int Sample) const { return FMath::Min(Sample / SamplesPerChunk, ChunkOrigins.Num() - 1); }
+
+	void Reset();
+
+	// Sizes the table. Chunk origins must be set before samples.
+	void SetNum(int NumSamples, int NumChunks, int InSamplesPerChunk);
+
+	void SetSample(int Sample, const FVector& Position, const FQuat& Rotation);
+
+	FVector GetPosition(int Sample) const { return ChunkOrigins[GetChunk(Sample)] + FVector(PositionX[Sample], PositionY[Sample], PositionZ[Sample]); }
+
+	FQuat GetRotation(int Sample) const { return FQuat(RotationX[Sample], RotationY[Sample], RotationZ[Sample], RotationW[Sample]); }
+
+	// Rotation interpolated at a fractional sample index, in float.
+	FQuat4f SampleRotation(float Sample) const;
+
+	// Transforms interpolated at fractional sample indices, positions linearly between samples. Interpolation stays chunk relative in float;
+	// each result is moved to its chunk origin and through ToOutput once on the way out.
+	void SampleTransforms(TArrayView<const float> Samples, const FTransform& ToOutput, TArrayView<FTransform> OutTransforms) const;
+
+	SIZE_T GetAllocatedSize() const;
+
+	void Serialize(FArchive& Ar);
+};
+
+USTRUCT(BlueprintType)
+struct FSGTrackSurfaceHit
+{
+	GENERATED_USTRUCT_BODY()
+
+	// True if the query location projects inside the profile's lateral extent.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bOnSurface = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector Location = FVector::ZeroVector;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector Normal = FVector::UpVector;
+
+	// Corrected track frame at InputKey, located on the spline centerline.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FTransform Frame = FTransform::Identity;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float InputKey = 0.f;
+
+	// Signed offset along the corrected right vector, before clamping to the profile.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float LateralOffset = 0.f;
+
+	// Signed distance from the surface along Normal. Negative means below the surface.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float HeightAboveSurface = 0.f;
+
+	FSGTrackSurfaceHit()
+		: bOnSurface(false),
+		Location(FVector::ZeroVector),
+		Normal(FVector::UpVector),
+		Frame(FTransform::Identity),
+		InputKey(0.f),
+		LateralOffset(0.f),
+		HeightAboveSurface(0.f)
+	{}
+};
+
 /**
  * 
  */
@@ -14,6 +253,8 @@ class SPLINEGEN_API USGSplineComponent : public USplineComponent
 {
 	GENERATED_BODY()
 
+	friend struct FSGSplineCursor;
+
 public:	
 	// Sets default values for this component's properties
 	USGSplineComponent();
@@ -33,10 +274,188 @@ protected:
 	UPROPERTY(BlueprintReadOnly)
 	float OffsetSplineEstimatedLength = 0.f;
 
+	// Incremented by every UpdateSpline, so dependent caches can tell when they're stale.
+	uint32 SplineRevision = 0;
+
+	// SplineRevision UpdateSGSplines last completed for. Starts out invalid, so nothing is derived until it's needed.
+	std::atomic<uint32> DerivedDataRevision { MAX_uint32 };
+
+	// The mode properties the derived data was built with aren't covered by SplineRevision, and Blueprint and editor writes to them bypass any setter.
+	// Their key is recorded when UpdateSGSplines completes, and for the frame table when it's baked, and compared by the validity checks.
+	uint32 DerivedDataInputKey = 0;
+
+	uint32 BakedFrameInputKey = 0;
+
+	// Bumped for edits to entries of SegmentRollConfigs and SplineCurveRoll, which the keys only see the sizes of.
+	uint32 DerivedDataInputRevision = 0;
+
+	// O(1) keys of those inputs: the frame table's, and the frame table's plus the arc length and offset curve settings.
+	uint32 ComputeFrameInputKey() const;
+
+	uint32 ComputeDerivedDataInputKey() const;
+
+	// Thread running UpdateSGSplines, whose own queries use the data built so far instead of waiting on it.
+	std::atomic<uint32> DerivedDataBuildThreadId { 0 };
+
+	FCriticalSection DerivedDataLock;
+
+	// Builds the derived curves and tables on first use after a spline change. Called by the query entry points before they read them.
+	void EnsureDerivedData() const;
+
+	// Derived data loaded with the component, and the hash of the inputs it was built from. UpdateSGSplines uses it as is while the hash still matches.
+	FSHAHash SerializedDerivedDataHash;
+
+	bool bHasSerializedDerivedData = false;
+
+	// Hash of the inputs UpdateSGSplines last completed with, taken when it completes. Saved with the tables, since the properties may have changed since.
+	FSHAHash BuiltDerivedDataHash;
+
+	// Hash of every property the derived data depends on, and of its format version.
+	FSHAHash ComputeDerivedDataHash() const;
+
+	// Reads or writes the derived curves and frame tables, as stored in the Derived Data Cache. Returns false on an archive error, having changed nothing when loading.
+	bool SerializeDerivedData(FArchive& Ar);
+
+	// Power-basis coefficients per segment. Position and scale are rebuilt by UpdateCurveCoefficients on every UpdateSpline and used while CurveCoefficientRevision matches SplineRevision;
+	// up vector segments are rebuilt with the up vector curve itself and used while UpVectorCoefficientRevision does. Keys are the point indices, as USplineComponent keeps them.
+	FSGCubicSegmentArray PositionSegments;
+
+	FSGCubicSegmentArray ScaleSegments;
+
+	FSGCubicSegmentArray UpVectorSegments;
+
+	uint32 CurveCoefficientRevision = 0;
+
+	uint32 UpVectorCoefficientRevision = 0;
+
+	// Rebuilds UpVectorSegments from SplineCurveUpVector. Called by UpdateUpVectorSpline.
+	void UpdateUpVectorCoefficients();
+
+	// Segment and local T for InKey, clamped to the range Segments covers. Returns false if Segments is empty.
+	bool LocateCurveSegment(const FSGCubicSegmentArray& Segments, float InKey, int& OutSegment, double& OutT) const;
+
+	// Local space position, derivative, up vector and scale at InKey, from the coefficient cache when it's current and the curves otherwise.
+	FVector EvalPosition(float InKey) const;
+
+	FVector EvalPositionDerivative(float InKey) const;
+
+	FVector EvalUpVector(float InKey) const;
+
+	FVector EvalScale(float InKey) const;
+
+	// Distance along the spline at the start of each segment plus the total, from Gauss-Legendre quadrature. Only used while ArcLengthRevision matches SplineRevision.
+	TArray<double> ExactSegmentDistances;
+
+	uint32 ArcLengthRevision = 0;
+
+	// Component scale the arc length tables were built with. Integration keeps using it after the component is rescaled, so queries agree with the tables.
+	FVector ArcLengthScale3D = FVector::OneVector;
+
+	bool HasExactArcLengths() const { return ExactSegmentDistances.Num() > 1 && ArcLengthRevision == SplineRevision && CurveCoefficientRevision == SplineRevision; }
+
+	// Length of Segment from its start to T, with the component scale applied like USplineComponent does. Order 5 Gauss-Legendre over SubIntervals pieces.
+	double IntegrateSegmentLength(int Segment, double T, int SubIntervals = 1) const;
+
+	// Exact mode distance to input key: find the segment, then Newton steps from the linear guess.
+	float GetExactInputKeyAtDistance(float Distance) const;
+
+	// T in Segment where the length from the segment start reaches LocalTarget, by Newton steps from GuessT.
+	double SolveExactSegmentT(int Segment, double LocalTarget, double GuessT) const;
+
+	// Length of Segment between T0 and T1. IntegrateSegmentLength is the T0 = 0 case.
+	double IntegrateSegmentRange(int Segment, double T0, double T1, int SubIntervals = 1) const;
+
+	// Adaptive reparam table: distance and input key per sample, plus the first sample index of each AdaptiveReparamBucketSize wide distance bucket.
+	TArray<double> AdaptiveReparamDistances;
+
+	TArray<float> AdaptiveReparamKeys;
+
+	TArray<int32> AdaptiveReparamBuckets;
+
+	double AdaptiveReparamBucketSize = 0.0;
+
+	bool HasAdaptiveReparamTable() const { return AdaptiveReparamKeys.Num() > 1 && HasExactArcLengths(); }
+
+	float GetAdaptiveInputKeyAtDistance(float Distance) const;
+
+	// Subdivides Segment until linear interpolation between samples is within AdaptiveReparamTolerance, appending the samples after its start.
+	void BuildAdaptiveReparamSegment(int Segment, TArray<double>& OutDistances, TArray<float>& OutKeys) const;
+
+	// Layout per segment, rebuilt by UpdateSegmentLayouts. Only used while it matches SplineRevision, TargetMeshLength and the distances GetCorrectDistanceAlongSplineAtSplineInputKey uses.
+	TArray<FSGSegmentLayout> SegmentLayouts;
+
+	uint32 SegmentLayoutRevision = 0;
+
+	float SegmentLayoutTargetMeshLength = 0.f;
+
+	bool bSegmentLayoutsUseExactLengths = false;
+
+	bool UsesExactArcLengths() const { return ArcLengthMode != ESGArcLengthMode::ReparamTable && HasExactArcLengths(); }
+
+	bool HasSegmentLayouts() const { return SegmentLayoutRevision == SplineRevision && SegmentLayoutTargetMeshLength == TargetMeshLength && bSegmentLayoutsUseExactLengths == UsesExactArcLengths() && SegmentLayouts.Num() == GetNumberOfSplineSegments(); }
+
+	// Layout of Segment derived from the spline's distances. An empty layout for an index outside the segments.
+	FSGSegmentLayout ComputeSegmentLayout(int Segment) const;
+
+	// Builds the exact segment lengths and the adaptive table. See UpdateArcLengthTable.
+	void BuildArcLengthTables();
+
+	// Local space frames sampled every 1/SamplesPerChunk input keys, one chunk per segment. Only used while BakedFrameRevision matches SplineRevision and BakedFrameInputKey the current inputs.
+	FSGFrameTable BakedFrames;
+
+	// Replaces BakedFrames when bCompressBakedFrames is set.
+	FSGCompressedFrameTable CompressedFrames;
+
+	uint32 BakedFrameRevision = 0;
+
+	bool HasBakedFrames() const { return UpVectorMode != ESGUpVectorMode::HermiteCurve && (BakedFrames.Num() > 1 || CompressedFrames.Num() > 1) && BakedFrameRevision == SplineRevision && BakedFrameInputKey == ComputeFrameInputKey(); }
+
+	// Interpolated frame from BakedFrames. Returns false if the table is missing or stale.
+	bool SampleBakedFrame(float InKey, FQuat& OutQuat) const;
+
+	// Unit tangents and rotation-minimising reference up vectors at every frame table sample, starting from world up. Closed loops spread the reference frame's holonomy over the loop so it closes.
+	void BuildReferenceFrames(int SamplesPerSegment, TArray<FVector>& OutTangents, TArray<FVector>& OutUps) const;
+
+	// Radians of roll from the reference frame to the authored up vector at each point, including the closing point of a loop. Continuous across points.
+	void ComputeAuthoredPointRolls(int SamplesPerSegment, const TArray<FVector>& Tangents, const TArray<FVector>& Ups, TArray<float>& OutPointRolls) const;
+
+	// Fits a non-empty SplineCurveRoll with the wrong number of points to the current points, keeping the authored roll along the spline.
+	void ResampleRollChannel();
+
 public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere)
 	FInterpCurveVector SplineCurveUpVector;
 
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	ESGUpVectorMode UpVectorMode = ESGUpVectorMode::HermiteCurve;
+
+	// Roll easing per segment in EasedRoll mode, indexed by the segment's start point. Missing entries use the default FRollConfig.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(EditCondition="UpVectorMode==ESGUpVectorMode::EasedRoll"))
+	TArray<FRollConfig> SegmentRollConfigs;
+
+	// Roll in degrees per point relative to the reference frame, for RollChannel mode. Fill it from the up vectors with ConvertUpVectorCurveToRollChannel.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(EditCondition="UpVectorMode==ESGUpVectorMode::RollChannel"))
+	FInterpCurveFloat SplineCurveRoll;
+
+	// Whole turns in degrees a closed loop rolls relative to its reference frame. Added evenly along the loop so SplineCurveRoll itself closes without a spin.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(EditCondition="UpVectorMode==ESGUpVectorMode::RollChannel"))
+	float RollChannelLoopTwist = 0.f;
+
+	UPROPERTY(BlueprintReadWrite, EditAnywhere)
+	ESGArcLengthMode ArcLengthMode = ESGArcLengthMode::ReparamTable;
+
+	// Largest distance error allowed between adaptive reparam table samples.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ClampMin=0.001, EditCondition="ArcLengthMode==ESGArcLengthMode::AdaptiveTable"))
+	float AdaptiveReparamTolerance = 0.5f;
+
+	// Frame table samples per segment for the baked up vector modes.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(ClampMin=1, EditCondition="UpVectorMode!=ESGUpVectorMode::HermiteCurve"))
+	int FramesPerSegment = 32;
+
+	// Keep the frame table in compressed form only: 16-bit octahedral axes, 16-bit chunk relative positions and half float scale. See GetFrameCompressionReport for the cost and error.
+	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(EditCondition="UpVectorMode!=ESGUpVectorMode::HermiteCurve"))
+	bool bCompressBakedFrames = false;
+
 	UPROPERTY(BlueprintReadWrite, EditAnywhere)
 	FInterpCurveVector SplineCurveLocalOffsetPosition;
 
@@ -54,12 +473,95 @@ public:
 	UPROPERTY(BlueprintReadWrite, EditAnywhere, meta=(EditCondition="bEnableLocalOffset"))
 	bool bEnableSmoothTangentsForLocalOffset;
 
+	virtual void UpdateSpline() override;
+
+	// Saves the frame tables with the component, so a load with unchanged inputs doesn't rebuild them.
+	virtual void Serialize(FArchive& Ar) override;
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+
+	// Builds the derived data for saving and cooking, through the Derived Data Cache.
+	virtual void PreSave(FObjectPreSaveContext SaveContext) override;
+
+	virtual void BeginCacheForCookedPlatformData(const ITargetPlatform* TargetPlatform) override;
+
+	// Fetches the derived data from the Derived Data Cache, or builds it and stores it there. Does nothing if it's current.
+	void BuildDerivedDataThroughDDC();
+#endif
+
+	uint32 GetSplineRevision() const { return SplineRevision; }
+
+	// Rebuilds all derived data: the up vector curve, coefficient cache, arc length tables, frame table and, when local offsets are enabled, the offset curve.
 	UFUNCTION(BlueprintCallable, meta = (Keywords = "UpdateSGSplines"), Category = "")
 	void UpdateSGSplines(bool bUpdateSplineFirst = false);
 
+	// True if the derived data matches the current spline and mode properties. Queries build it on first use otherwise.
+	UFUNCTION(BlueprintPure, meta = (Keywords = "IsDerivedDataValid"), Category = "")
+	bool IsDerivedDataValid() const { return DerivedDataRevision.load(std::memory_order_acquire) == SplineRevision && DerivedDataInputKey == ComputeDerivedDataInputKey() && (!UsesUpVectorCurve() || SplineCurveUpVector.Points.Num() == SplineCurves.Rotation.Points.Num()); }
+
+	// Call after changing entries of SegmentRollConfigs or SplineCurveRoll in place, so the next query rebuilds the derived data. Editor edits and changes to the other mode properties are picked up by themselves.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "Invalidate Roll"), Category = "")
+	void MarkDerivedDataInputsChanged();
+
+	// HermiteCurve and EasedRoll read SplineCurveUpVector. RollChannel and NoRoll skip building it.
+	bool UsesUpVectorCurve() const { return UpVectorMode == ESGUpVectorMode::HermiteCurve || UpVectorMode == ESGUpVectorMode::EasedRoll; }
+
+	// Builds the derived data now if it's stale, e.g. behind a loading screen, so the first query doesn't pay for it.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "WarmUpDerivedData"), Category = "")
+	void WarmUpDerivedData();
+
 	UFUNCTION(BlueprintCallable, meta = (Keywords = "UpdateUpVectorSpline"), Category = "")
 	void UpdateUpVectorSpline(bool bUpdateSplineFirst = false);
 
+	// Rebuilds the power-basis coefficient cache for the position and scale curves. Called by UpdateSpline.
+	void UpdateCurveCoefficients();
+
+	// Rebuilds the segment lengths for Exact mode, and the adaptive table for AdaptiveTable mode, then the segment layouts. Called by UpdateSGSplines; only updates the layouts in ReparamTable mode.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "UpdateArcLengthTable"), Category = "")
+	void UpdateArcLengthTable();
+
+	// Rebuilds the segment layout cache. Called by UpdateSpline in ReparamTable mode and by UpdateArcLengthTable. Until it runs again after a TargetMeshLength change, layouts are derived per query.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "UpdateSegmentLayouts"), Category = "")
+	void UpdateSegmentLayouts();
+
+	// Start distance, length and TargetMeshLength pieces of a segment, from the cache when it's current.
+	UFUNCTION(BlueprintPure, meta = (Keywords = "GetSegmentLayout"), Category = "")
+	FSGSegmentLayout GetSegmentLayout(int Segment) const;
+
+	// Input key at a distance along the spline, using the current ArcLengthMode. Exact mode falls back to the reparam table until it's been built.
+	UFUNCTION(BlueprintPure, meta = (Keywords = "GetCorrectInputKeyAtDistanceAlongSpline"), Category = "")
+	float GetCorrectInputKeyAtDistanceAlongSpline(float Distance) const;
+
+	// Total length of the spline, using the current ArcLengthMode.
+	UFUNCTION(BlueprintPure, meta = (Keywords = "GetCorrectSplineLength"), Category = "")
+	float GetCorrectSplineLength() const;
+
+	// Distance along the spline at an input key, using the current ArcLengthMode.
+	UFUNCTION(BlueprintPure, meta = (Keywords = "GetCorrectDistanceAlongSplineAtSplineInputKey"), Category = "")
+	float GetCorrectDistanceAlongSplineAtSplineInputKey(float InKey) const;
+
+	// Times and measures reparam table and exact distance to key lookups over evenly spread distances. Builds the exact lengths if needed.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "BenchmarkArcLengthModes"), Category = "")
+	FSGArcLengthBenchmarkResult BenchmarkArcLengthModes(int NumQueries = 100000);
+
+	// Bakes the frame table for the current UpVectorMode. Called by UpdateSGSplines; does nothing in HermiteCurve mode.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "UpdateFrameTable"), Category = "")
+	void UpdateFrameTable(bool bUpdateSplineFirst = false);
+
+	// Corrected transforms at many input keys, without scale. Baked modes read the frame table, with positions interpolated linearly between its samples
+	// (raise FramesPerSegment for accuracy); HermiteCurve mode, or a stale table, evaluates each key like GetCorrectTransformAtSplineInputKey.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "GetCorrectTransformsAtSplineInputKeys"), Category = "")
+	void GetCorrectTransformsAtSplineInputKeys(const TArray<float>& InKeys, ESplineCoordinateSpace::Type CoordinateSpace, TArray<FTransform>& OutTransforms) const;
+
+	// Memory per metre and error of the float32 and compressed frame tables for the current spline. Bakes the tables it needs, then restores the current one.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "GetFrameCompressionReport"), Category = "")
+	FSGFrameCompressionReport GetFrameCompressionReport();
+
+	// Rebuilds SplineCurveRoll from the current up vectors, optionally switching to RollChannel mode, and rebakes the frame table.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "ConvertUpVectorCurveToRollChannel"), Category = "")
+	void ConvertUpVectorCurveToRollChannel(bool bUseRollChannel = true);
+
 	UFUNCTION(BlueprintCallable, meta = (Keywords = "UpdateLocalOffsetPositionSpline"), Category = "")
 	void UpdateLocalOffsetPositionSpline(bool bUpdateSplineFirst = false);
 
@@ -93,6 +595,43 @@ public:
 	UFUNCTION(BlueprintPure, meta = (Keywords = "GetCorrectTransformAtDistanceAlongSpline"), Category = "")
 	FTransform GetCorrectTransformAtDistanceAlongSpline(float Distance, ESplineCoordinateSpace::Type CoordinateSpace, bool bUseScale) const;
 
+	// Corrected local space frame at InputKey. Same basis as GetCorrectQuaternionAtSplineInputKey, without building a rotation matrix.
+	void GetCorrectFrameAtSplineInputKey(float InKey, FVector& OutLocation, FVector& OutForward, FVector& OutRight, FVector& OutUp) const;
+
+	// Nearest input key to a local space location. A HintKey >= 0 (e.g. last frame's result) limits the search to the segments around it, falling back to the whole spline
+	// when the nearest point is on the edge of those segments or, with MaxHintDistance >= 0, further than that from the location.
+	float FindInputKeyClosestToLocalLocation(const FVector& LocalLocation, float HintKey = -1.f, float MaxHintDistance = -1.f) const;
+
+	// Analytic replacement for tracing against generated track collision. The surface is a flat strip ProfileExtent.X either side of the spline, raised ProfileExtent.Y along the corrected up vector.
+	UFUNCTION(BlueprintPure, meta = (Keywords = "QueryTrackSurface"), Category = "")
+	FSGTrackSurfaceHit QueryTrackSurface(const FVector& WorldLocation, FVector2D ProfileExtent, float HintKey = -1.f) const;
+
+	// Batched QueryTrackSurface. HintKeys warm starts each search when it matches WorldLocations in size, and is always overwritten with the result keys for the next call.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "QueryTrackSurfaceBatch"), Category = "")
+	void QueryTrackSurfaceBatch(const TArray<FVector>& WorldLocations, FVector2D ProfileExtent, UPARAM(ref) TArray<float>& HintKeys, TArray<FSGTrackSurfaceHit>& OutHits) const;
+
+	// Track coordinates: X is distance along spline, Y is offset along the corrected right vector, Z is offset along the corrected up vector.
+	UFUNCTION(BlueprintPure, meta = (Keywords = "GetTrackCoordinateAtLocation Frenet"), Category = "")
+	FVector GetTrackCoordinateAtLocation(const FVector& Location, ESplineCoordinateSpace::Type CoordinateSpace) const;
+
+	UFUNCTION(BlueprintPure, meta = (Keywords = "GetLocationAtTrackCoordinate Frenet"), Category = "")
+	FVector GetLocationAtTrackCoordinate(const FVector& TrackCoordinate, ESplineCoordinateSpace::Type CoordinateSpace) const;
+
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "GetTrackCoordinatesAtLocations Frenet"), Category = "")
+	void GetTrackCoordinatesAtLocations(const TArray<FVector>& Locations, ESplineCoordinateSpace::Type CoordinateSpace, TArray<FVector>& OutTrackCoordinates) const;
+
+	// SoA variant of GetTrackCoordinatesAtLocations.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "GetTrackCoordinatesAtLocationsSoA Frenet"), Category = "")
+	void GetTrackCoordinatesAtLocationsSoA(const TArray<FVector>& Locations, ESplineCoordinateSpace::Type CoordinateSpace, TArray<float>& OutDistances, TArray<float>& OutLateralOffsets, TArray<float>& OutVerticalOffsets) const;
+
+	// Batched GetLocalOffsetLocationAtDistanceAlongSpline, one offset per distance.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "GetLocationsAtTrackCoordinates Frenet"), Category = "")
+	void GetLocationsAtTrackCoordinates(const TArray<FVector>& TrackCoordinates, ESplineCoordinateSpace::Type CoordinateSpace, TArray<FVector>& OutLocations) const;
+
+	// SoA variant of GetLocationsAtTrackCoordinates. All input arrays must match in size.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "GetLocationsAtTrackCoordinatesSoA Frenet"), Category = "")
+	void GetLocationsAtTrackCoordinatesSoA(const TArray<float>& Distances, const TArray<float>& LateralOffsets, const TArray<float>& VerticalOffsets, ESplineCoordinateSpace::Type CoordinateSpace, TArray<FVector>& OutLocations) const;
+
 	UFUNCTION(BlueprintPure, meta = (Keywords = "GetLastSplinePoint"), Category = "")
 	int GetLastSplinePoint() const;
 
@@ -118,7 +657,7 @@ public:
 	int WrapSplinePointToRange(int SplinePoint) const;
 
 	UFUNCTION(BlueprintPure, meta = (Keywords = "GetSegmentLength"), Category = "")
-	int GetSegmentLength(int SplinePoint) const;
+	float GetSegmentLength(int SplinePoint) const;
 
 	UFUNCTION(BlueprintPure, meta = (Keywords = "GetLocalOffsetLocationAtSplineInputKey"), Category = "")
 	FVector GetLocalOffsetLocationAtSplineInputKey(float InKey, FVector2D NewLocalOffset, ESplineCoordinateSpace::Type CoordinateSpace);
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USplineComponent;
+class USGSplineComponent;
+
+// Distance to input key lookups for queries that only move a short way each time, like walking a section or following a vehicle along the track.
+// The cursor remembers the table bracket of its last query and steps from there, so a monotone walk costs O(1) per query instead of a binary search.
+// Long jumps fall back to a binary search. Keys match GetCorrectInputKeyAtDistanceAlongSpline on a USGSplineComponent, and the reparam table on any other spline.
+// The cursor doesn't keep the spline alive and is meant to live on the stack or next to the spline's user.
+struct SPLINEGEN_API FSGSplineCursor
+{
+	FSGSplineCursor() = default;
+
+	explicit FSGSplineCursor(const USplineComponent* InSpline);
+
+	// Binds the cursor to InSpline and forgets the last bracket.
+	void Reset(const USplineComponent* InSpline);
+
+	// Input key at Distance along the spline, using the spline's current ArcLengthMode.
+	float GetInputKeyAtDistance(float Distance);
+
+	const USplineComponent* GetSpline() const { return Spline; }
+
+	// Curve segment the last returned key lies in.
+	int GetSegment() const { return Segment; }
+
+private:
+	enum class ETable : uint8
+	{
+		Reparam,
+		Exact,
+		Adaptive
+	};
+
+	// Picks the table for the spline's current mode. Forgets the bracket if the table or the spline revision changed since the last query.
+	void Validate();
+
+	const USplineComponent* Spline = nullptr;
+
+	const USGSplineComponent* SGSpline = nullptr;
+
+	ETable Table = ETable::Reparam;
+
+	uint32 Revision = 0;
+
+	// Index of the table sample at or before the last query. In Exact mode the table is the segment distances, so this is the curve segment.
+	int Bracket = 0;
+
+	int Segment = 0;
+
+	// Exact mode only: the last local target distance and T in Bracket, used to warm start Newton. Negative when there's none.
+	double LastLocalTarget = -1.0;
+
+	double LastT = -1.0;
+};
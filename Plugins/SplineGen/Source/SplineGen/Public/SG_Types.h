@@ -136,6 +136,97 @@ struct FMeshSplineDivisions
 	//{}
 };
 
+// Replaces the SplinePointMap/SegmentCountMap pair of the legacy pipeline. Mesh spline start points are prefix sums of the per user segment counts,
+// kept in a Fenwick tree so changing one segment's count and looking up a start point are both O(log n). Opaque to BP, see the accessor nodes in SplineGenBPLibrary.
+USTRUCT(BlueprintType)
+struct FMeshSplinePointIndex
+{
+	GENERATED_USTRUCT_BODY()
+
+	UPROPERTY()
+	TArray<int> SegmentCounts;
+
+	// 1-based Fenwick tree over SegmentCounts.
+	UPROPERTY()
+	TArray<int> Tree;
+
+	FMeshSplinePointIndex()
+		: SegmentCounts({}), Tree({ 0 })
+	{}
+
+	void Reset(const TArray<int>& InSegmentCounts)
+	{
+		SegmentCounts = InSegmentCounts;
+		// Init rather than SetNumZeroed, which would keep the old nodes and build on top of them.
+		Tree.Init(0, SegmentCounts.Num() + 1);
+		for (int i = 1; i <= SegmentCounts.Num(); i++)
+		{
+			Tree[i] += SegmentCounts[i - 1];
+			const int Parent = i + (i & -i);
+			if (Parent <= SegmentCounts.Num()) Tree[Parent] += Tree[i];
+		}
+	}
+
+	int Num() const
+	{
+		return SegmentCounts.Num();
+	}
+
+	int GetSegmentCount(int Segment) const
+	{
+		return SegmentCounts.IsValidIndex(Segment) ? SegmentCounts[Segment] : 0;
+	}
+
+	// First mesh spline point of Segment. Segment == Num() gives the total point offset.
+	int GetStartPoint(int Segment) const
+	{
+		int Sum = 0;
+		for (int i = FMath::Clamp(Segment, 0, Num()); i > 0; i -= i & -i) Sum += Tree[i];
+		return Sum;
+	}
+
+	void SetSegmentCount(int Segment, int Count)
+	{
+		if (!SegmentCounts.IsValidIndex(Segment)) return;
+		const int Difference = Count - SegmentCounts[Segment];
+		SegmentCounts[Segment] = Count;
+		for (int i = Segment + 1; i <= Num(); i += i & -i) Tree[i] += Difference;
+	}
+
+	void AddSegment(int Count)
+	{
+		if (Tree.Num() == 0) Tree.Add(0);
+		SegmentCounts.Add(Count);
+		const int NewNode = Num();
+		Tree.Add(Count + GetStartPoint(NewNode - 1) - GetStartPoint(NewNode - (NewNode & -NewNode)));
+	}
+
+	// User segment whose mesh spline range contains MeshPoint.
+	int FindSegmentFromPoint(int MeshPoint) const
+	{
+		if (Num() == 0) return -1;
+		int Position = 0;
+		int Remaining = MeshPoint;
+		for (int Step = 1 << FMath::FloorLog2(uint32(Num())); Step > 0; Step >>= 1)
+		{
+			if (Position + Step <= Num() && Tree[Position + Step] <= Remaining)
+			{
+				Position += Step;
+				Remaining -= Tree[Position];
+			}
+		}
+		return FMath::Min(Position, Num() - 1);
+	}
+
+	void ToMaps(TArray<int>& OutSplinePointMap, TArray<int>& OutSegmentCountMap) const
+	{
+		OutSegmentCountMap = SegmentCounts;
+		OutSplinePointMap.SetNumUninitialized(Num() + 1);
+		OutSplinePointMap[0] = 0;
+		for (int i = 0; i < Num(); i++) OutSplinePointMap[i + 1] = OutSplinePointMap[i] + SegmentCounts[i];
+	}
+};
+
 /*
 USTRUCT(BlueprintType)
 struct FControlPointMap
@@ -51,6 +51,15 @@ class USplineGenBPLibrary : public UBlueprintFunctionLibrary
 	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Update Spline Point"), Category = "SplineGen")
 	static void SetSplinePoint(USplineComponent* Spline, const int SplinePointIndex, const FSplinePointSetting SplinePointData, bool bUpdate);
 
+	// Bulk SetSplinePoint. Grows the spline once, writes the curve points directly and updates the spline at most once.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Update Spline Points Bulk"), Category = "SplineGen")
+	static void SetSplinePoints(USplineComponent* Spline, const int StartIndex, UPARAM(ref) const TArray<FSplinePointSetting>& SplinePoints, bool bUpdate);
+
+	// Streams a CSV track export (see SGCSVImport.h) into Spline, replacing its points, with one spline update. Positions are scaled by PositionScale, e.g. metres to centimetres.
+	// Returns false with OutError if the file can't be read or a column is missing or bad, leaving Spline unchanged. Logs rows per second.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Import CSV Track"), Category = "SplineGen")
+	static bool ImportCSVTrack(USGSplineComponent* Spline, const FString& Filename, FString& OutError, float PositionScale = 100.f, bool bConvertFromYUp = true, bool bClosedLoop = false);
+
 	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Trim Spline"), Category = "SplineGen")
 	static bool TrimSpline(USplineComponent* Spline, const int NewLastIndex);
 
@@ -66,12 +75,20 @@ class USplineGenBPLibrary : public UBlueprintFunctionLibrary
 	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Calculate Mesh Spline Divisions From User"), Category = "SplineGen")
 	static FMeshSplineDivisions CalcMeshSplineDivisionsFromUserSplineSegment(const USplineComponent* UserSpline, const USplineComponent* MeshSpline, const int UserSplinePoint, const float RequestSegmentLength = 100);
 
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Get Mesh Spline Section Points"), Category = "SplineGen")
+	static void GetMeshSplineSectionPoints(const USplineComponent* UserSpline, const int UserSplinePoint, FMeshSplineDivisions SplineDivisions, TArray<FSplinePointSetting>& OutPoints);
+
 	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Update Mesh Spline User Segment"), Category = "SplineGen")
 	static int UpdateMeshSplineSection(const USplineComponent* UserSpline, const USplineComponent* GenRefSpline, USplineComponent* GenMeshSpline, const int UserSplinePoint, const int MeshSplineStartingPoint, const float TargetMeshSegmentLength, const bool bClearSpline, const bool bGenSplineDivisions, FMeshSplineDivisions SplineDivisions, UPARAM(ref) const FRollConfig& RollConfig);
 
+	// For one-off eases. Per-point loops should fill an array of alphas and ease it with SelectEaseInterpArray.
 	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Selected Ease Interp"), Category = "SplineGen")
 	static const float SelectEaseInterp(const float A, const float B, const float Alpha, UPARAM(ref) const FRollConfig& RollConfig);
 
+	// Eases a whole array of alphas in place, resolving the roll config once.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Select Ease Interp Array"), Category = "SplineGen")
+	static void SelectEaseInterpArray(const float A, const float B, UPARAM(ref) TArray<float>& Alphas, UPARAM(ref) const FRollConfig& RollConfig);
+
 	UFUNCTION(BlueprintPure, meta = (Keywords = "SplineGen Find Mesh Spline Starting Point From User Point"), Category = "SplineGen")
 	static const int FindMeshSplineStartingPointFromUserPoint(const USplineComponent* UserSpline, const USplineComponent* GenMeshSpline, const int ControlPointOnUserSpline);
 
@@ -111,6 +128,10 @@ class USplineGenBPLibrary : public UBlueprintFunctionLibrary
 	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Update Style Region"), Category = "SplineGen")
 	static void UpdateStyleRegion(USplineComponent* UserSpline, int UserSegment, UPARAM(ref) TArray<USplineMeshComponent*>& SplineMeshes, UStaticMesh* Mesh, UPARAM(ref) TArray<UMaterialInterface*>& Materials, UPARAM(ref) TArray<int>& SplinePointMap, UPARAM(ref) TArray<int>& SegmentCountMap);
 
+	// Destroys a batch of spline meshes: unregisters them all first so render and physics state is torn down in one pass, then destroys them. Empties the array.
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Destroy Spline Meshes"), Category = "SplineGen")
+	static void DestroySplineMeshes(UPARAM(ref) TArray<USplineMeshComponent*>& SplineMeshes);
+
 	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Clear All"), Category = "SplineGen")
 	static void ClearAll(USplineComponent* GenRefSpline, USplineComponent* GenMeshSpline, UPARAM(ref) TArray<int>& SplinePointMap, UPARAM(ref) TArray<int>& SegmentCountMap, UPARAM(ref) TArray<USplineMeshComponent*>& SplineMeshes, AActor* Actor);
 
@@ -120,6 +141,47 @@ class USplineGenBPLibrary : public UBlueprintFunctionLibrary
 	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Update All"), Category = "SplineGen")
 	static void UpdateAll(USplineComponent* UserSpline, int UserSplinePoint, USplineComponent* GenRefSpline, USplineComponent* GenMeshSpline, UPARAM(ref) TArray<int>& SplinePointMap, UPARAM(ref) TArray<int>& SegmentCountMap, UPARAM(ref) TArray<USplineMeshComponent*>& SplineMeshes, AActor* Actor, UStaticMesh* Mesh, UPARAM(ref) TArray<UMaterialInterface*>& Materials, float RefSplineOffset, float TargetMeshSegmentLength, UPARAM(ref) const TArray<FRollConfig>& RollConfigs);
 
+	// Variants of the pipeline above that keep SplinePointMap/SegmentCountMap in an FMeshSplinePointIndex, so per-edit bookkeeping is O(log n) instead of O(n).
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Init Mesh Spline Indexed"), Category = "SplineGen")
+	static void InitMeshSplineIndexed(const USplineComponent* UserSpline, const USplineComponent* GenRefSpline, USplineComponent* GenMeshSpline, UPARAM(ref) FMeshSplinePointIndex& PointIndex, const float TargetMeshSegmentLength, UPARAM(ref) const TArray<FRollConfig>& RollConfigs);
+
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Set Mesh Spline Segment From User Spline Segment Indexed"), Category = "SplineGen")
+	static int SetMeshSplineRegionFromUserSplineSegmentIndexed(const USplineComponent* UserSpline, const USplineComponent* GenRefSpline, USplineComponent* GenMeshSpline, const int UserSplinePoint, UPARAM(ref) FMeshSplinePointIndex& PointIndex, const float TargetMeshSegmentLength, UPARAM(ref) const TArray<FRollConfig>& RollConfigs);
+
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Update Spline Mesh Region Indexed"), Category = "SplineGen")
+	static void UpdateSplineMeshRegionIndexed(const USplineComponent* UserSpline, const USplineComponent* GenMeshSpline, const int UserSegment, const int Shift, UPARAM(ref) const FMeshSplinePointIndex& PointIndex, UPARAM(ref) TArray<USplineMeshComponent*>& SplineMeshes, AActor* Actor, UStaticMesh* Mesh, UPARAM(ref) TArray<UMaterialInterface*>& Materials);
+
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Update Style Region Indexed"), Category = "SplineGen")
+	static void UpdateStyleRegionIndexed(USplineComponent* UserSpline, int UserSegment, UPARAM(ref) TArray<USplineMeshComponent*>& SplineMeshes, UStaticMesh* Mesh, UPARAM(ref) TArray<UMaterialInterface*>& Materials, UPARAM(ref) const FMeshSplinePointIndex& PointIndex);
+
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Clear All Indexed"), Category = "SplineGen")
+	static void ClearAllIndexed(USplineComponent* GenRefSpline, USplineComponent* GenMeshSpline, UPARAM(ref) FMeshSplinePointIndex& PointIndex, UPARAM(ref) TArray<USplineMeshComponent*>& SplineMeshes, AActor* Actor);
+
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Init All Indexed"), Category = "SplineGen")
+	static void InitAllIndexed(USplineComponent* UserSpline, USplineComponent* GenRefSpline, USplineComponent* GenMeshSpline, UPARAM(ref) FMeshSplinePointIndex& PointIndex, UPARAM(ref) TArray<USplineMeshComponent*>& SplineMeshes, AActor* Actor, UStaticMesh* Mesh, UPARAM(ref) TArray<UMaterialInterface*>& Materials, float RefSplineOffset, float TargetMeshSegmentLength, UPARAM(ref) const TArray<FRollConfig>& RollConfigs);
+
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Update All Indexed"), Category = "SplineGen")
+	static void UpdateAllIndexed(USplineComponent* UserSpline, int UserSplinePoint, USplineComponent* GenRefSpline, USplineComponent* GenMeshSpline, UPARAM(ref) FMeshSplinePointIndex& PointIndex, UPARAM(ref) TArray<USplineMeshComponent*>& SplineMeshes, AActor* Actor, UStaticMesh* Mesh, UPARAM(ref) TArray<UMaterialInterface*>& Materials, float RefSplineOffset, float TargetMeshSegmentLength, UPARAM(ref) const TArray<FRollConfig>& RollConfigs);
+
+	UFUNCTION(BlueprintPure, meta = (Keywords = "SplineGen Make Mesh Spline Point Index"), Category = "SplineGen")
+	static FMeshSplinePointIndex MakeMeshSplinePointIndex(const TArray<int>& SegmentCountMap);
+
+	UFUNCTION(BlueprintPure, meta = (Keywords = "SplineGen Break Mesh Spline Point Index"), Category = "SplineGen")
+	static void BreakMeshSplinePointIndex(const FMeshSplinePointIndex& PointIndex, TArray<int>& SplinePointMap, TArray<int>& SegmentCountMap);
+
+	// Indexed replacement for FindMeshSplineStartingPointFromUserPoint.
+	UFUNCTION(BlueprintPure, meta = (Keywords = "SplineGen Get Mesh Spline Starting Point From Index"), Category = "SplineGen")
+	static int GetMeshSplineStartingPointFromIndex(const FMeshSplinePointIndex& PointIndex, const int UserSplinePoint);
+
+	UFUNCTION(BlueprintPure, meta = (Keywords = "SplineGen Get Mesh Spline Segment Count From Index"), Category = "SplineGen")
+	static int GetMeshSplineSegmentCountFromIndex(const FMeshSplinePointIndex& PointIndex, const int UserSegment);
+
+	UFUNCTION(BlueprintPure, meta = (Keywords = "SplineGen Get User Segment From Mesh Spline Point"), Category = "SplineGen")
+	static int GetUserSegmentFromMeshSplinePoint(const FMeshSplinePointIndex& PointIndex, const int MeshSplinePoint);
+
+	UFUNCTION(BlueprintPure, meta = (Keywords = "SplineGen Get Mesh Spline Point Index Num"), Category = "SplineGen")
+	static int GetMeshSplinePointIndexNum(const FMeshSplinePointIndex& PointIndex);
+
 	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Get Spline Meshes Of Region"), Category = "SplineGen")
 	static TArray<USplineMeshComponent*> GetSplineMeshesOfRegion(int UserSegment, UPARAM(ref) TArray<int>& SplinePointMap, TArray<USplineMeshComponent*>& SplineMeshes);
 
@@ -135,6 +197,9 @@ class USplineGenBPLibrary : public UBlueprintFunctionLibrary
 	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Find Roll Curve"), Category = "SplineGen")
 	static float GenRollCurve(float Value, float Min, float Max, const float StartTangentLength, const float EndTangentLength, const float SegmentLength);
 
+	UFUNCTION(BlueprintCallable, meta = (Keywords = "SplineGen Find Roll Curve Array"), Category = "SplineGen")
+	static void GenRollCurveArray(UPARAM(ref) TArray<float>& Values, const float StartTangentLength, const float EndTangentLength, const float SegmentLength);
+
 	UFUNCTION(BlueprintPure, meta = (Keywords = "SplineGen Find Corrected Roll At Distance Along Spline"), Category = "SplineGen")
 	static float FindCorrectedRollAtDistanceAlongSpline(const USplineComponent* Spline, const float DistanceAlongSpline, const ESplineCoordinateSpace::Type CoordinateSpace);
 
@@ -41,7 +41,11 @@ public class SplineGen : ModuleRules
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
-		
+
+		if (Target.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.Add("DerivedDataCache");
+		}
 		
 		DynamicallyLoadedModuleNames.AddRange(
 			new string[]